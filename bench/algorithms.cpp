@@ -0,0 +1,191 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+
+// Algorithms memory benchmark: size of the algorithms, heap allocations and time for the usual algorithms operations
+// (scrambles, copies, additions, cancellations) and heap allocations and retained memory for full CFOP solves
+// The allocations are counted replacing the global new and delete operators. The program must be executed in the
+// directory with the XML (or compiled) files, as ssmaster
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+
+#include "../src/cfop.h"
+
+using namespace grcube3;
+
+static std::atomic<std::size_t> Allocations(0u), AllocatedBytes(0u), LiveBytes(0u);
+
+// Each block has a header with his size, so the live memory can be updated when it is deleted
+static constexpr std::size_t HeaderSize = alignof(std::max_align_t);
+
+void* operator new(std::size_t Size)
+{
+	void* P = std::malloc(Size + HeaderSize);
+	if (P == nullptr) throw std::bad_alloc();
+	*static_cast<std::size_t*>(P) = Size;
+	Allocations++;
+	AllocatedBytes += Size;
+	LiveBytes += Size;
+	return static_cast<char*>(P) + HeaderSize;
+}
+
+void operator delete(void* P) noexcept
+{
+	if (P == nullptr) return;
+	void* Block = static_cast<char*>(P) - HeaderSize;
+	LiveBytes -= *static_cast<std::size_t*>(Block);
+	std::free(Block);
+}
+
+void* operator new[](std::size_t Size) { return operator new(Size); }
+void operator delete[](void* P) noexcept { operator delete(P); }
+void operator delete(void* P, std::size_t) noexcept { operator delete(P); }
+void operator delete[](void* P, std::size_t) noexcept { operator delete(P); }
+
+// Allocations counter snapshot
+struct AllocationsCount
+{
+	std::size_t Count, Bytes, Live;
+
+	static AllocationsCount Now() { return { Allocations.load(), AllocatedBytes.load(), LiveBytes.load() }; }
+};
+
+static void PrintRow(const std::string& Name, const double Time, const AllocationsCount& Start, const AllocationsCount& End, const uint Items)
+{
+	std::cout << std::left << std::setw(24) << Name << std::right << std::fixed << std::setprecision(2)
+			  << std::setw(12) << 1.0e3 * Time << std::setw(14) << static_cast<double>(End.Count - Start.Count) / Items
+			  << std::setw(14) << static_cast<double>(End.Bytes - Start.Bytes) / Items << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	const uint NumAlgs = argc > 1 ? static_cast<uint>(std::stoi(argv[1])) : 100000u,
+			   NumSolves = argc > 2 ? static_cast<uint>(std::stoi(argv[2])) : 2u,
+			   CrossDepth = 5u, AlgLength = 20u;
+
+	std::cout << "Algorithm size: " << sizeof(Algorithm) << " bytes (step size: " << sizeof(Stp) << " bytes)\n\n";
+
+	std::cout << std::left << std::setw(24) << "Operation" << std::right << std::setw(12) << "Time ms"
+			  << std::setw(14) << "Allocs/item" << std::setw(14) << "Bytes/item" << std::endl;
+
+	std::size_t Check = 0u; // Results checksum (the compiler can't skip the operations)
+
+	AllocationsCount Start = AllocationsCount::Now();
+	auto time_start = std::chrono::steady_clock::now();
+	std::vector<Algorithm> Scrambles;
+	Scrambles.reserve(NumAlgs);
+	for (uint n = 0u; n < NumAlgs; n++) Scrambles.push_back(Algorithm(AlgLength));
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - time_start;
+	const AllocationsCount Stored = AllocationsCount::Now();
+	PrintRow("Random scrambles", elapsed.count(), Start, Stored, NumAlgs);
+	const double ScrambleBytes = static_cast<double>(Stored.Live - Start.Live) / NumAlgs; // Memory for each stored scramble
+
+	Start = AllocationsCount::Now();
+	time_start = std::chrono::steady_clock::now();
+	std::vector<Algorithm> Copies;
+	Copies.reserve(NumAlgs);
+	for (const auto& A : Scrambles) Copies.push_back(A);
+	elapsed = std::chrono::steady_clock::now() - time_start;
+	PrintRow("Copies", elapsed.count(), Start, AllocationsCount::Now(), NumAlgs);
+
+	Start = AllocationsCount::Now();
+	time_start = std::chrono::steady_clock::now();
+	for (uint n = 0u; n < NumAlgs; n++)
+	{
+		Algorithm A = Copies[n] + Scrambles[(n + 1u) % NumAlgs].GetSubAlgorithm(0u, 8u);
+		Check += A.GetSize();
+	}
+	elapsed = std::chrono::steady_clock::now() - time_start;
+	PrintRow("Additions", elapsed.count(), Start, AllocationsCount::Now(), NumAlgs);
+
+	Start = AllocationsCount::Now();
+	time_start = std::chrono::steady_clock::now();
+	for (const auto& A : Copies) { Algorithm I = A; I.TransformReverseInvert(); Check += I.GetSize(); }
+	elapsed = std::chrono::steady_clock::now() - time_start;
+	PrintRow("Inverse copies", elapsed.count(), Start, AllocationsCount::Now(), NumAlgs);
+
+	Check += Algorithm::GetCancellation2Size(); // Load the cancellations before the measure
+	Start = AllocationsCount::Now();
+	time_start = std::chrono::steady_clock::now();
+	for (const auto& A : Scrambles) Check += A.GetCancellations().GetSize();
+	elapsed = std::chrono::steady_clock::now() - time_start;
+	PrintRow("Cancellations", elapsed.count(), Start, AllocationsCount::Now(), NumAlgs);
+
+	// Cancellations with rules that consume the last steps (the steps must not be appended again)
+	const std::vector<Algorithm> TestRules = { "R U R' U'", "M", "U D", "E" }; // Source and target pairs
+	const std::vector<std::pair<Algorithm, Algorithm>> TestCases =
+	{
+		{ "F R U R' U'", "F M" }, // Four steps source at the end
+		{ "R U R' U'", "M" }, // Four steps source as the whole algorithm
+		{ "F U D F'", "F E F'" }, // Two steps source before the last step
+		{ "F U D", "F E" } // Two steps source at the end
+	};
+	uint Errors = 0u;
+	for (const auto& T : TestCases)
+	{
+		const Algorithm A = T.first.GetCancellations(TestRules);
+		if (A == T.second) continue;
+		std::cout << "Cancellations error: " << T.first.ToString() << " -> " << A.ToString() << " (expected " << T.second.ToString() << ")\n";
+		Errors++;
+	}
+
+	std::cout << "\nStored scrambles: " << std::setprecision(2) << ScrambleBytes << " bytes per scramble\n";
+
+	// Full CFOP solves (crosses, F2L, OLL and PLL) in a single thread
+	Check += Cube::GetAlgorithms(AlgSets::OLL).GetCasesNumber() + Cube::GetAlgorithms(AlgSets::PLL).GetCasesNumber();
+	std::size_t SolveAllocations = 0u, SolveBytes = 0u, RetainedBytes = 0u;
+	double SolveTime = 0.0;
+	for (uint n = 0u; n < NumSolves; n++)
+	{
+		const AllocationsCount SolveStart = AllocationsCount::Now();
+		time_start = std::chrono::steady_clock::now();
+		{
+			CFOP Solver(Scrambles[n], 1);
+			Solver.SearchCrosses(CrossDepth);
+			Solver.SearchF2L();
+			Solver.SearchOLL();
+			Solver.SearchPLL();
+			RetainedBytes += LiveBytes.load() - SolveStart.Live + sizeof(CFOP);
+			Check += Solver.GetReport(true).size();
+		}
+		elapsed = std::chrono::steady_clock::now() - time_start;
+		SolveTime += elapsed.count();
+		const AllocationsCount SolveEnd = AllocationsCount::Now();
+		SolveAllocations += SolveEnd.Count - SolveStart.Count;
+		SolveBytes += SolveEnd.Bytes - SolveStart.Bytes;
+	}
+	if (NumSolves > 0u)
+		std::cout << "CFOP solves (depth " << CrossDepth << "): " << 1.0e3 * SolveTime / NumSolves << " ms, "
+				  << SolveAllocations / NumSolves << " allocations, " << SolveBytes / NumSolves << " bytes allocated, "
+				  << RetainedBytes / NumSolves << " bytes retained per solve" << std::endl;
+
+	std::cout << "\nChecksum: " << Check << std::endl;
+	return Errors == 0u ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+// Movements microbenchmark: Cube::ApplyStep against CubeLanes::ApplyStep with the same random algorithms, and
+// algorithms evaluation (cross and F2L pairs checks over a base cube) with Cube against CubeBatch
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include "../src/cube.h"
+#include "../src/cube_lanes.h"
+#include "../src/cube_batch.h"
+
+using namespace grcube3;
+
+int main(int argc, char* argv[])
+{
+	const uint NumAlgs = argc > 1 ? static_cast<uint>(std::stoi(argv[1])) : 100000u, AlgLength = 20u, Rounds = 10u;
+
+	std::vector<Algorithm> Algs;
+	for (uint n = 0u; n < NumAlgs; n++) Algs.push_back(Algorithm(AlgLength));
+
+	std::vector<Spn> Spins; // Random spins, so the movements are not always the same layers
+	for (uint n = 0u; n < NumAlgs; n++) Spins.push_back(static_cast<Spn>(Algs[n].GetSize() > 0u ? static_cast<uint>(Algs[n].At(0)) % 24u : 0u));
+
+	S64 Check = 0ull; // Results checksum (the compiler can't skip the movements)
+	uint Errors = 0u;
+
+	// Cube movements
+	std::vector<Cube> Cubes(NumAlgs);
+	const auto time_cube_start = std::chrono::system_clock::now();
+	for (uint r = 0u; r < Rounds; r++)
+	{
+		for (uint n = 0u; n < NumAlgs; n++)
+		{
+			Cube& C = Cubes[n];
+			C.Reset();
+			C.SetSpin(Spins[n]);
+			for (uint s = 0u; s < Algs[n].GetSize(); s++) C.ApplyStep(Algs[n].At(s));
+			Check += C.GetEdgesStatus() ^ C.GetCornersStatus();
+		}
+	}
+	const std::chrono::duration<double> cube_elapsed_seconds = std::chrono::system_clock::now() - time_cube_start;
+
+	// Lanes movements
+	std::vector<CubeLanes> Lanes(NumAlgs);
+	Cube Start;
+	const auto time_lanes_start = std::chrono::system_clock::now();
+	for (uint r = 0u; r < Rounds; r++)
+	{
+		for (uint n = 0u; n < NumAlgs; n++)
+		{
+			CubeLanes& L = Lanes[n];
+			Start.Reset();
+			Start.SetSpin(Spins[n]);
+			L.Set(Start);
+			for (uint s = 0u; s < Algs[n].GetSize(); s++) L.ApplyStep(Algs[n].At(s));
+			Check += L.GetEdgesStatus() ^ L.GetCornersStatus();
+		}
+	}
+	const std::chrono::duration<double> lanes_elapsed_seconds = std::chrono::system_clock::now() - time_lanes_start;
+
+	for (uint n = 0u; n < NumAlgs; n++)
+		if (Cubes[n].GetEdgesStatus() != Lanes[n].GetEdgesStatus() || Cubes[n].GetCornersStatus() != Lanes[n].GetCornersStatus()) Errors++;
+
+	S64 Moves = 0ull;
+	for (const auto& A : Algs) Moves += A.GetSize();
+	Moves *= Rounds;
+
+	std::cout << "Algorithms: " << NumAlgs << " x " << Rounds << " rounds, " << Moves << " movements" << std::endl;
+	std::cout << "Cube::ApplyStep: " << cube_elapsed_seconds.count() << " s (" << 1.0e9 * cube_elapsed_seconds.count() / Moves << " ns/move)" << std::endl;
+	std::cout << "CubeLanes::ApplyStep (" << CubeLanes::GetKernel() << "): " << lanes_elapsed_seconds.count() << " s (" <<
+				 1.0e9 * lanes_elapsed_seconds.count() / Moves << " ns/move)" << std::endl;
+	std::cout << "Speedup: " << cube_elapsed_seconds.count() / lanes_elapsed_seconds.count() << std::endl;
+	std::cout << "Different results: " << Errors << " (checksum " << Check << ")" << std::endl;
+
+	// Algorithms evaluation over a base cube (as in the F2L evaluation)
+	const Pgr Groups[5] = { Pgr::CROSS_D, Pgr::F2L_D_DFR, Pgr::F2L_D_DFL, Pgr::F2L_D_DBR, Pgr::F2L_D_DBL };
+	const Algorithm BaseScramble(AlgLength);
+	const Cube Base(BaseScramble);
+	uint CubeSolved = 0u, BatchSolved = 0u;
+
+	const auto time_eval_cube_start = std::chrono::system_clock::now();
+	for (uint n = 0u; n < NumAlgs; n++)
+	{
+		Cube C = Base;
+		C.ApplyAlgorithm(Algs[n]);
+		for (const auto G : Groups) if (C.IsSolved(G)) CubeSolved++;
+	}
+	const std::chrono::duration<double> eval_cube_elapsed_seconds = std::chrono::system_clock::now() - time_eval_cube_start;
+
+	const auto time_eval_batch_start = std::chrono::system_clock::now();
+	const LanesMask Masks[5] = { LanesMask(Groups[0]), LanesMask(Groups[1]), LanesMask(Groups[2]), LanesMask(Groups[3]), LanesMask(Groups[4]) };
+	CubeBatch Batch;
+	for (uint n = 0u; n < NumAlgs; n += CubeBatch::MaxSize)
+	{
+		Batch.SetAlgorithms(Base, Algs, n);
+		for (const auto& M : Masks) for (uint b = Batch.IsSolved(M); b != 0u; b &= b - 1u) BatchSolved++;
+	}
+	const std::chrono::duration<double> eval_batch_elapsed_seconds = std::chrono::system_clock::now() - time_eval_batch_start;
+
+	std::cout << "Evaluation with Cube: " << eval_cube_elapsed_seconds.count() << " s (" << 1.0e9 * eval_cube_elapsed_seconds.count() / NumAlgs << " ns/algorithm)" << std::endl;
+	std::cout << "Evaluation with CubeBatch: " << eval_batch_elapsed_seconds.count() << " s (" << 1.0e9 * eval_batch_elapsed_seconds.count() / NumAlgs << " ns/algorithm)" << std::endl;
+	std::cout << "Speedup: " << eval_cube_elapsed_seconds.count() / eval_batch_elapsed_seconds.count() << std::endl;
+	std::cout << "Solved groups: " << CubeSolved << " / " << BatchSolved << std::endl;
+	if (CubeSolved != BatchSolved) Errors++;
+
+	return Errors == 0u ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+// Startup benchmark: time and resident memory to load the algorithms collections and cancellations needed by each
+// method (with the default algsets). Each method is measured in a new process (started by this program), and the
+// program must be executed in the directory with the XML (or compiled) files, as ssmaster
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+#include "../src/cube.h"
+
+using namespace grcube3;
+
+struct Profile
+{
+	std::string Name; // Method name
+	std::vector<AlgSets> Sets; // Algsets used by the method (default algsets)
+	bool Cancellations; // The method needs the cancellations (all solves use them for the inspections)
+};
+
+static const std::vector<Profile> Profiles =
+{
+	{ "scrambles", { }, false },
+	{ "lbl", { }, true },
+	{ "cfop", { AlgSets::OLL, AlgSets::PLL }, true },
+	{ "roux", { AlgSets::CMLL }, true },
+	{ "zz", { AlgSets::ZBLL }, true },
+	{ "petrus", { AlgSets::ZBLL }, true },
+	{ "all", { AlgSets::_1LLL, AlgSets::OLL, AlgSets::PLL, AlgSets::ZBLL, AlgSets::OCLL, AlgSets::CMLL, AlgSets::COLL, AlgSets::EPLL }, true }
+};
+
+// Resident memory of the current process in kB (0 if not available)
+static uint GetResidentMemory()
+{
+	std::ifstream f("/proc/self/status");
+	std::string line;
+	while (std::getline(f, line)) if (line.compare(0u, 6u, "VmRSS:") == 0) return static_cast<uint>(std::stoul(line.substr(6u)));
+	return 0u;
+}
+
+// Load the data for a method and print the load time and resident memory
+static int RunProfile(const Profile& P)
+{
+	const uint MemoryStart = GetResidentMemory();
+	const auto time_start = std::chrono::steady_clock::now();
+	uint Cases = 0u;
+	for (const auto AS : P.Sets) Cases += Cube::GetAlgorithms(AS).GetCasesNumber();
+	if (P.Cancellations) Cases += Algorithm::GetCancellation2Size() + Algorithm::GetCancellation3Size();
+	const std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - time_start;
+	std::cout << 1.0e3 * elapsed_seconds.count() << " " << MemoryStart << " " << GetResidentMemory() << " " << Cases << std::endl;
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1) // Child process for a method
+	{
+		for (const auto& P : Profiles) if (P.Name == argv[1]) return RunProfile(P);
+		return 1;
+	}
+
+	std::cout << std::left << std::setw(12) << "Method" << std::right << std::setw(12) << "Process ms" << std::setw(12) << "Load ms"
+			  << std::setw(12) << "RSS kB" << std::setw(12) << "Loaded kB" << std::setw(10) << "Items" << std::endl;
+
+	uint Errors = 0u;
+	for (const auto& P : Profiles)
+	{
+		const auto time_start = std::chrono::steady_clock::now();
+		FILE* Child = popen((std::string(argv[0]) + " " + P.Name).c_str(), "r");
+		if (Child == nullptr) { Errors++; continue; }
+		char Buffer[256] = { 0 };
+		const bool Read = std::fgets(Buffer, sizeof(Buffer), Child) != nullptr;
+		const int Status = pclose(Child);
+		const std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - time_start;
+		if (!Read || Status != 0) { Errors++; continue; }
+
+		double LoadTime;
+		uint MemoryStart, MemoryEnd, Items;
+		std::istringstream(Buffer) >> LoadTime >> MemoryStart >> MemoryEnd >> Items;
+
+		std::cout << std::left << std::setw(12) << P.Name << std::right << std::fixed << std::setprecision(2)
+				  << std::setw(12) << 1.0e3 * elapsed_seconds.count() << std::setw(12) << LoadTime
+				  << std::setw(12) << MemoryEnd << std::setw(12) << MemoryEnd - MemoryStart << std::setw(10) << Items << std::endl;
+	}
+
+	return Errors == 0u ? 0 : 1;
+}
@@ -21,16 +21,91 @@
 */
 
 #include <random>
+#include <unordered_map>
 
 #include "algorithm.h"
+#include "collection.h"
 #include "tinyxml2.h"
 
 using namespace tinyxml2;
 
 namespace grcube3
 {
-	const std::vector<Algorithm> Algorithm::Cancellations2 = LoadXMLCancellationsFile("cancel2.xml"); // Load two steps cancellations
-	const std::vector<Algorithm> Algorithm::Cancellations3 = LoadXMLCancellationsFile("cancel3.xml"); // Load three steps cancellations
+	// Two and three steps cancellations, loaded the first time they are required
+	const LazyFile<std::vector<Algorithm>> Algorithm::Cancellations2 =
+		{ "cancel2.xml", [](std::vector<Algorithm>& Canc, const std::string& Filename) { Canc = LoadCancellationsFile(Filename); } };
+	const LazyFile<std::vector<Algorithm>> Algorithm::Cancellations3 =
+		{ "cancel3.xml", [](std::vector<Algorithm>& Canc, const std::string& Filename) { Canc = LoadCancellationsFile(Filename); } };
+
+	// Cancellation rules (a source steps sequence replaced by a target algorithm) in a trie over the steps codes, so
+	// all the rules with a source that starts in an algorithm position are found walking the trie once from there
+	class CancellationTrie
+	{
+	public:
+		static constexpr uint None = 0xFFFFFFFFu; // No rule
+
+		CancellationTrie() { NodeRules.push_back(None); } // Root node (empty source)
+
+		// Add a rule (if there is a rule with the same source, the first one is kept)
+		void Add(const Algorithm& Source, const Algorithm& Target)
+		{
+			uint Node = 0u;
+			for (uint n = 0u; n < Source.GetSize(); n++)
+			{
+				const auto Edge = Edges.find(GetEdgeKey(Node, Source.At(n)));
+				if (Edge != Edges.end()) Node = Edge->second;
+				else
+				{
+					Edges[GetEdgeKey(Node, Source.At(n))] = static_cast<uint>(NodeRules.size());
+					Node = static_cast<uint>(NodeRules.size());
+					NodeRules.push_back(None);
+				}
+			}
+			if (Node == 0u || NodeRules[Node] != None) return;
+			NodeRules[Node] = static_cast<uint>(Targets.size());
+			Targets.push_back(Target);
+			if (Source.GetSize() > MaxLength) MaxLength = Source.GetSize();
+		}
+
+		// Rules for the sources that start in the given algorithm position, by source length (Rules needs MaxLength + 1
+		// elements), returns the number of steps walked (the rules with longer sources are not updated)
+		uint Match(const Algorithm& A, const uint Pos, std::vector<uint>& Rules) const
+		{
+			uint Node = 0u, Len = 0u;
+			while (Pos + Len < A.GetSize() && Len < MaxLength)
+			{
+				const auto Edge = Edges.find(GetEdgeKey(Node, A.At(Pos + Len)));
+				if (Edge == Edges.end()) break;
+				Node = Edge->second;
+				Rules[++Len] = NodeRules[Node];
+			}
+			return Len;
+		}
+
+		const Algorithm& GetTarget(const uint r) const { return Targets[r]; } // Target algorithm for a rule
+		uint GetMaxLength() const { return MaxLength; } // Longest source length
+
+	private:
+		std::unordered_map<uint, uint> Edges; // Child node for each node and step
+		std::vector<uint> NodeRules; // Rule for the source that ends in each node (None if the node is not a source end)
+		std::vector<Algorithm> Targets; // Target algorithm for each rule
+		uint MaxLength = 0u; // Longest source length
+
+		static uint GetEdgeKey(const uint Node, const Stp S) { return (Node << 8) | static_cast<uint>(S); }
+	};
+
+	// Cancellations from all files in a trie (built the first time it is required)
+	const CancellationTrie& Algorithm::GetCancellationRules()
+	{
+		static const CancellationTrie Rules = []()
+		{
+			CancellationTrie T;
+			for (const auto* Canc : { &Cancellations2.Get(), &Cancellations3.Get() })
+				for (size_t n = 0u; n + 1u < Canc->size(); n += 2u) T.Add((*Canc)[n], (*Canc)[n + 1u]);
+			return T;
+		}();
+		return Rules;
+	}
 
 	// Array with subjective score for each movement
 	const uint Algorithm::m_scores[]
@@ -1149,15 +1224,15 @@ namespace grcube3
 	}
 
 	// Addition operator
-	Algorithm Algorithm::operator+(const Algorithm& rhalg)
+	Algorithm Algorithm::operator+(const Algorithm& rhalg) const &
 	{
 		Algorithm Aux = *this;
-		for (uint i = 0u; i < rhalg.GetSize(); i++) Aux.Append(rhalg.At(i));
+		Aux.Append(rhalg);
 		return Aux;
 	}
 
 	 // Step addition operator
-	Algorithm Algorithm::operator+(const Stp rhalg)
+	Algorithm Algorithm::operator+(const Stp rhalg) const &
 	{
 		Algorithm Aux = *this;
 		Aux.Append(rhalg);
@@ -2192,90 +2267,77 @@ namespace grcube3
     }
 
 	// Returns the algorithm with cancellations applied
-	Algorithm Algorithm::GetCancellations() const 
+	Algorithm Algorithm::GetCancellations() const { return GetCancellations(GetCancellationRules()); }
+
+	// Returns the algorithm with the given cancellations (source and target pairs) applied
+	Algorithm Algorithm::GetCancellations(const std::vector<Algorithm>& Canc) const
 	{
+		CancellationTrie Rules;
+		for (size_t n = 0u; n + 1u < Canc.size(); n += 2u) Rules.Add(Canc[n], Canc[n + 1u]);
+		return GetCancellations(Rules);
+	}
+
+	// Returns the algorithm with the cancellation rules applied
+	// Steps are read from left to right: a three steps source is tried if the steps are in the same axis or are turns,
+	// else a two steps source if the first two steps are in the same axis (or the three steps are turns). Sources with
+	// more steps are tried first, without conditions. The last two steps are tested at the end if they are not already
+	// consumed by a cancellation
+	Algorithm Algorithm::GetCancellations(const CancellationTrie& Rules) const
+	{
+		std::vector<uint> Matches(Rules.GetMaxLength() + 1u, CancellationTrie::None); // Rules for each source length
+
 		Algorithm ACanc, ADev = GetDeveloped();
 		while (ADev.Shrink());
 
-		for (uint i = 0u; i < ADev.GetSize() - 2u; i++)
+		if (ADev.GetSize() < 2u) return ADev;
+
+		uint i = 0u; // First step not consumed
+		for (; i < ADev.GetSize() - 2u; i++)
 		{
-			bool AllTurns = Algorithm::IsTurn(ADev.At(i)) && Algorithm::IsTurn(ADev.At(i + 1u)) && Algorithm::IsTurn(ADev.At(i + 2u));
+			const uint Walked = Rules.Match(ADev, i, Matches);
+
+			bool found = false;
+			for (uint len = Walked; len > 3u && !found; len--) // Long sources
+			{
+				if (Matches[len] != CancellationTrie::None)
+				{
+					ACanc += Rules.GetTarget(Matches[len]);
+					i += len - 1u;
+					found = true;
+				}
+			}
+			if (found) continue;
+
+			const bool AllTurns = Algorithm::IsTurn(ADev.At(i)) && Algorithm::IsTurn(ADev.At(i + 1u)) && Algorithm::IsTurn(ADev.At(i + 2u));
 			if (SameAxisSteps(ADev.At(i), ADev.At(i + 1u)) || AllTurns)
 			{
-				if (SameAxisSteps(ADev.At(i), ADev.At(i + 2u)) || AllTurns) // Test three steps cancellations
+				if ((SameAxisSteps(ADev.At(i), ADev.At(i + 2u)) || AllTurns) && Walked >= 3u && Matches[3] != CancellationTrie::None)
 				{
-					bool found = false;
-					const Algorithm A3 = ADev.GetSubAlgorithm(i, 3u);
-					for (size_t n = 0u; n < Cancellations3.size(); n += 2u)
-					{
-						if (A3 == Cancellations3[n])
-						{
-							ACanc += Cancellations3[n + 1u];
-							i += 2u;
-							found = true;
-							break;
-						}
-					}
-					if (!found) // Test two steps cancellations
-					{
-						const Algorithm A2 = ADev.GetSubAlgorithm(i, 2u);
-						for (size_t n = 0u; n < Cancellations2.size(); n += 2u)
-						{
-							if (A2 == Cancellations2[n])
-							{
-								ACanc += Cancellations2[n + 1u];
-								found = true;
-								i++;
-								break;
-							}
-						}
-						if (!found) ACanc.Append(ADev.At(i));
-					}
+					ACanc += Rules.GetTarget(Matches[3]); // Three steps cancellation
+					i += 2u;
 				}
-				else if (!AllTurns) // Test two steps cancellations
+				else if (Walked >= 2u && Matches[2] != CancellationTrie::None)
 				{
-					bool found = false;
-					const Algorithm A2 = ADev.GetSubAlgorithm(i, 2u);
-					for (size_t n = 0u; n < Cancellations2.size(); n += 2u)
-					{
-						if (A2 == Cancellations2[n])
-						{
-							ACanc += Cancellations2[n + 1u];
-							found = true;
-							i++;
-							break;
-						}
-					}
-					if (!found) ACanc.Append(ADev.At(i));
+					ACanc += Rules.GetTarget(Matches[2]); // Two steps cancellation
+					i++;
 				}
+				else ACanc.Append(ADev.At(i));
 			}
 			else ACanc.Append(ADev.At(i));
 		}
 
-		if (SameAxisSteps(ADev.At(ADev.GetSize() - 2u), ADev.At(ADev.GetSize() - 1u))) // Test the last two steps
+		const uint Last = ADev.GetSize() - 2u; // Test the last two steps (if they are not consumed)
+		if (i == Last)
 		{
-			bool found = false;
-			const Algorithm A2 = ADev.GetSubAlgorithm(ADev.GetSize() - 2u, 2u);
-			for (size_t n = 0u; n < Cancellations2.size(); n += 2u)
-			{
-				if (A2 == Cancellations2[n])
-				{
-					ACanc += Cancellations2[n + 1u];
-					found = true;
-					break;
-				}
-			}
-			if (!found)
+			if (SameAxisSteps(ADev.At(Last), ADev.At(Last + 1u)) && Rules.Match(ADev, Last, Matches) >= 2u && Matches[2] != CancellationTrie::None)
+				ACanc += Rules.GetTarget(Matches[2]);
+			else
 			{
-				ACanc.Append(ADev.At(ADev.GetSize() - 2u));
-				ACanc.Append(ADev.At(ADev.GetSize() - 1u));
+				ACanc.Append(ADev.At(Last));
+				ACanc.Append(ADev.At(Last + 1u));
 			}
 		}
-		else
-		{
-			ACanc.Append(ADev.At(ADev.GetSize() - 2u));
-			ACanc.Append(ADev.At(ADev.GetSize() - 1u));
-		}
+		else if (i == Last + 1u) ACanc.Append(ADev.At(Last + 1u)); // Only the last step is not consumed
 
 		return ACanc;
 	}
@@ -2439,6 +2501,28 @@ namespace grcube3
 		return Canc;
 	}
 	
+	// Load a collection of cancellation algorithms from the compiled file for the given XML file if it exists, else from the XML file
+	std::vector<Algorithm> Algorithm::LoadCancellationsFile(const std::string& XMLFilename)
+	{
+		Collection CancCol;
+		if (CancCol.LoadCompiledCollectionFile(Collection::GetCompiledFilename(XMLFilename)) && (CancCol.GetCaseAlgorithms(0u).size() & 1u) == 0u)
+			return CancCol.GetCaseAlgorithms(0u);
+		return LoadXMLCancellationsFile(XMLFilename);
+	}
+
+	// Convert an XML cancellations file to his compiled file (a collection with a case for all cancellations)
+	bool Algorithm::CompileXMLCancellationsFile(const std::string& XMLFilename)
+	{
+		Case CancCase;
+		CancCase.Name = "Cancellations";
+		CancCase.Algs = LoadXMLCancellationsFile(XMLFilename);
+		if (CancCase.Algs.empty()) return false;
+
+		Collection CancCol;
+		CancCol.AddData(CancCase);
+		return CancCol.SaveCompiledCollectionFile(Collection::GetCompiledFilename(XMLFilename), false); // Effects are not needed
+	}
+	
 	// Half turn metric (HTM), also known as face turn metric (FTM)
 	uint Algorithm::GetHTM() const
 	{
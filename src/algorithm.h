@@ -25,11 +25,16 @@
 #include <string>
 #include <array>
 #include <vector>
+#include <utility>
 
 #include "cube_definitions.h"
+#include "lazy_file.h"
+#include "step_buffer.h"
 
 namespace grcube3
 {
+	class CancellationTrie;
+
 	class Algorithm
 	{
 	public:
@@ -37,14 +42,15 @@ namespace grcube3
 		Algorithm(const uint n) { Append(n); } // Random algorithm constructor
 		Algorithm(const char* s) { const std::string ss(s); Append(ss); } // Algorithm from chars array
 		Algorithm(const std::string& s) { Append(s); } // Algorithm from string constructor
-		~Algorithm() { } // Destructor
 		
 		Stp& operator[](const uint pos) { return Movs[pos]; } // Return step at position (read/write)
         Stp At(const uint pos) const { return pos < Movs.size() ? Movs[pos] : Stp::NONE; } // Return step at position (read only)
 		bool operator==(const Algorithm&) const; // Equal operator
 		bool operator!=(const Algorithm&) const; // Not equal operator
-		Algorithm operator+(const Algorithm&); // Algorithm addition operator
-		Algorithm operator+(const Stp); // Step addition operator
+		Algorithm operator+(const Algorithm&) const &; // Algorithm addition operator
+		Algorithm operator+(const Stp) const &; // Step addition operator
+		Algorithm operator+(const Algorithm& rhalg) && { Append(rhalg); return std::move(*this); } // Addition to a temporary algorithm
+		Algorithm operator+(const Stp rhstp) && { Append(rhstp); return std::move(*this); } // Addition to a temporary algorithm
         Algorithm& operator+=(const Algorithm& rhalg)	{ Append(rhalg); return *this; } // Add algorithm operator
         Algorithm& operator+=(const Stp rhstp) { Append(rhstp); return *this; } // Add step operator
 		
@@ -94,7 +100,12 @@ namespace grcube3
 		void Append(const Stp stp) { Movs.push_back(stp); } // Append given step at the end of the algorithm (no shrink)
 		bool AppendShrink(const Stp stp) { Movs.push_back(stp);  return ShrinkLast(); } // Append given step at the end of the algorithm and shrink it
 		// Append given algorithm at the end of the algorithm (no shrinking)
-		void Append(const Algorithm& A) { for (uint n = 0u; n < A.GetSize(); n++) Append(A.At(n)); }
+		void Append(const Algorithm& A)
+		{
+			const uint n = A.GetSize(); // The algorithm can be appended to himself (no reallocation after the reserve)
+			Movs.reserve(Movs.size() + n);
+			for (uint i = 0u; i < n; i++) Movs.push_back(A.Movs[i]);
+		}
 		bool Append(const std::string&); // Append given text algorithm at the end of the algorithm (no shrink)
         void Append(const uint, const Stp = Stp::U, const Stp = Stp::L2); // Append random movements (by default U, D, F, B, R ,L) until get the given size (with shrink)
 
@@ -109,6 +120,7 @@ namespace grcube3
 		Algorithm GetSubAlgorithm(const uint, const uint) const; // Gets a sub-algorithm from an algorithm position with given length
 		Algorithm GetWithoutTurns() const; // Returns an algorithm removing x, y and z turns from the algorithm (maintaining the functionality)
 		Algorithm GetCancellations() const; // Returns the algorithm with cancellations applied
+		Algorithm GetCancellations(const std::vector<Algorithm>&) const; // Returns the algorithm with the given cancellations (source and target pairs) applied
 		Algorithm GetRegrip() const; // Returns the same algorithm with turns for getting most comfortable (subjective) movements
 		
 		bool Shrink(); // Returns false if the algorithm is shrinked; if returns true apply shrink again
@@ -194,8 +206,13 @@ namespace grcube3
 		static bool JoinSteps(const Stp, const Stp, Stp&); // Join two steps, return true if the join has been done
 		static bool JoinSteps(const Stp, const Stp, const Stp, Stp&); // Join two steps with a middle step, return true if the join has been done
 
-		static uint GetCancellation2Size() { return static_cast<uint>(Cancellations2.size()); }
-		static uint GetCancellation3Size() { return static_cast<uint>(Cancellations3.size()); }
+		// Cancellations number (the cancellations are loaded the first time they are required)
+		static uint GetCancellation2Size() { return static_cast<uint>(Cancellations2.Get().size()); }
+		static uint GetCancellation3Size() { return static_cast<uint>(Cancellations3.Get().size()); }
+		static bool AreCancellationsLoaded() { return Cancellations2.IsLoaded() && Cancellations3.IsLoaded(); }
+
+		// Convert an XML cancellations file to his compiled file (a collection with a case for all cancellations)
+		static bool CompileXMLCancellationsFile(const std::string&);
 		
 		// static arrays with all turns, y turns, all single movements and U slice movements
 		const static std::array<Stp, 9u> Turns;
@@ -203,7 +220,7 @@ namespace grcube3
 		const static std::array<Stp, 18u> SingleMovs;
 
 	private:
-		std::vector<Stp> Movs; // Algorithm movements (steps)
+		StepBuffer Movs; // Algorithm movements (steps), short algorithms without heap memory
 	
 		const static Stp m_x[]; // Array for x turn
 		const static Stp m_xp[]; // Array for x' turn
@@ -244,11 +261,19 @@ namespace grcube3
 		
 		const static uint m_scores[]; // Array with subjective score for each movement
 
-		const static std::vector<Algorithm> Cancellations2, Cancellations3; // Cancellations
+		const static LazyFile<std::vector<Algorithm>> Cancellations2, Cancellations3; // Cancellations (loaded when required)
 		
 		static Stp GetStepFromString(const std::string&, uint, uint&); // Get a step inside the string
 
 		// Load a collection of cancelllation algorithms from an XML file
 		static std::vector<Algorithm> LoadXMLCancellationsFile(const std::string&);
+
+		// Load a collection of cancellation algorithms from the compiled file for the given XML file if it exists, else from the XML file
+		static std::vector<Algorithm> LoadCancellationsFile(const std::string&);
+
+		// Cancellations from all files in a trie (built the first time it is required)
+		static const CancellationTrie& GetCancellationRules();
+
+		Algorithm GetCancellations(const CancellationTrie&) const; // Returns the algorithm with the cancellation rules applied
 	};
 }
@@ -0,0 +1,306 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+#include <algorithm>
+
+#include "bidirectional.h"
+
+namespace grcube3
+{
+	std::vector<std::unique_ptr<PiecesSymmetry>> PiecesSymmetry::Symmetries;
+	std::mutex PiecesSymmetry::SymmetriesMutex;
+
+	// Solved pieces state (all edges oriented)
+	PiecesState PiecesState::Solved()
+	{
+		PiecesState S;
+		for (uint n = 0u; n < 12u; n++) S.ESlots[n] = static_cast<uint8_t>(n * 2u);
+		for (uint n = 0u; n < 8u; n++) S.CSlots[n] = static_cast<uint8_t>(n * 3u);
+		S.EO = 0xFFFu;
+		return S;
+	}
+
+	// Set the target from the edges and corners solve masks (each piece position must be fully checked or not checked)
+	bool BidirectionalTarget::Set(const S64 MaskE, const S64 MaskC, const bool AllEO)
+	{
+		Edges.clear();
+		Corners.clear();
+		EO = AllEO;
+
+		for (uint p = 0u; p < 12u; p++) // Edges
+		{
+			const S64 Pos = (MaskE >> (4u * p)) & 0xFu, Dir = (MaskE >> (48u + p)) & 0x1u;
+			if (Pos == 0xFu) Edges.push_back({ p, Dir != 0u });
+			else if (Pos != 0u || Dir != 0u) return false;
+		}
+
+		for (uint p = 0u; p < 8u; p++) // Corners
+		{
+			const S64 Pos = (MaskC >> (8u * p)) & 0x7u, Dir = (MaskC >> (8u * p + 4u)) & 0x3u;
+			if (Pos == 0x7u) Corners.push_back({ p, Dir != 0u });
+			else if (Pos != 0u || Dir != 0u) return false;
+		}
+
+		return Fits();
+	}
+
+	// Fold the target into the canonical target with the given symmetry (the images of the pieces must be the canonical pieces)
+	bool BidirectionalTarget::Fold(const BidirectionalTarget& Canonical, const PiecesSymmetry* PSym)
+	{
+		if (PSym == nullptr || EO || Canonical.EO || Canonical.Sym != nullptr ||
+			Edges.size() != Canonical.Edges.size() || Corners.size() != Canonical.Corners.size()) return false;
+
+		for (const auto& P : Edges)
+		{
+			const PruningPiece Image = { PSym->GetEdgeImage(P.Position), P.Direction };
+			if (std::find(Canonical.Edges.begin(), Canonical.Edges.end(), Image) == Canonical.Edges.end()) return false;
+		}
+		for (const auto& P : Corners)
+		{
+			const PruningPiece Image = { PSym->GetCornerImage(P.Position), P.Direction };
+			if (std::find(Canonical.Corners.begin(), Canonical.Corners.end(), Image) == Canonical.Corners.end()) return false;
+		}
+
+		Edges = Canonical.Edges;
+		Corners = Canonical.Corners;
+		Sym = PSym;
+		Table = Canonical.Table;
+		return true;
+	}
+
+	// Get the pieces state from the cube
+	PiecesState PiecesMoves::GetState(const Cube& C)
+	{
+		PiecesState S;
+		PruningTable::GetEdgesSlots(C.GetEdgesStatus(), S.ESlots);
+		PruningTable::GetCornersSlots(C.GetCornersStatus(), S.CSlots);
+		S.EO = 0u;
+		for (uint p = 0u; p < 12u; p++) if (C.CheckOrientation(Cube::EdpToPcp(static_cast<Edp>(p)))) S.EO |= 1u << p;
+		return S;
+	}
+
+	// Get the movements for the cube spin: each step is identified with a single layer movement from the pruning tables
+	// Returns false if a step can't be identified (checked with a second cube)
+	bool PiecesMoves::Update(const Cube& C)
+	{
+		const PiecesState S0 = GetState(C);
+
+		for (uint m = 0u; m < 18u; m++)
+		{
+			Cube CM = C;
+			CM.ApplyStep(static_cast<Stp>(m + 1u));
+			const PiecesState S1 = GetState(CM);
+
+			uint pm = 0u; // Movement without spin
+			for (; pm < 18u; pm++)
+			{
+				const uint8_t *EMovs = PruningTable::GetEdgesMovs(pm), *CMovs = PruningTable::GetCornersMovs(pm);
+				bool Match = true;
+				for (uint n = 0u; n < 12u && Match; n++) Match = EMovs[S0.ESlots[n]] == S1.ESlots[n];
+				for (uint n = 0u; n < 8u && Match; n++) Match = CMovs[S0.CSlots[n]] == S1.CSlots[n];
+				if (Match) break;
+			}
+			if (pm == 18u) return false;
+
+			for (uint n = 0u; n < 24u; n++)
+			{
+				EdgesMovs[m][n] = PruningTable::GetEdgesMovs(pm)[n];
+				CornersMovs[m][n] = PruningTable::GetCornersMovs(pm)[n];
+			}
+			for (uint p = 0u; p < 12u; p++) EdgesPos[m][p] = EdgesMovs[m][p * 2u] / 2u;
+
+			EOFlips[m] = 0u; // Edges orientation changes (orientation depends on the spin)
+			for (uint p = 0u; p < 12u; p++)
+				if (((S0.EO >> p) & 1u) != ((S1.EO >> EdgesPos[m][p]) & 1u)) EOFlips[m] |= 1u << EdgesPos[m][p];
+		}
+
+		Cube CCheck = C;
+		for (uint m = 0u; m < 18u; m++) CCheck.ApplyStep(static_cast<Stp>(m + 1u));
+		return Check(CCheck);
+	}
+
+	// Check if a step has the same movement than the step in other movements (with other spin)
+	bool PiecesMoves::SameMovement(const Stp S, const PiecesMoves& PM, const Stp PMS) const
+	{
+		const uint m = static_cast<uint>(S) - 1u, pm = static_cast<uint>(PMS) - 1u;
+		for (uint n = 0u; n < 24u; n++)
+			if (EdgesMovs[m][n] != PM.EdgesMovs[pm][n] || CornersMovs[m][n] != PM.CornersMovs[pm][n]) return false;
+		return true;
+	}
+
+	// Check the movements with the given cube
+	bool PiecesMoves::Check(const Cube& C) const
+	{
+		const PiecesState S0 = GetState(C);
+
+		for (uint m = 0u; m < 18u; m++)
+		{
+			Cube CM = C;
+			CM.ApplyStep(static_cast<Stp>(m + 1u));
+			const PiecesState S1 = GetState(CM);
+
+			PiecesState S = S0;
+			Apply(S, static_cast<Stp>(m + 1u));
+
+			if (S.EO != S1.EO) return false;
+			for (uint n = 0u; n < 12u; n++) if (S.ESlots[n] != S1.ESlots[n]) return false;
+			for (uint n = 0u; n < 8u; n++) if (S.CSlots[n] != S1.CSlots[n]) return false;
+		}
+		return true;
+	}
+
+	// Build the table from the keys and packed steps sequences
+	void HalfSearchTable::Build(const std::vector<S64>& SKeys, const std::vector<uint>& SSteps)
+	{
+		uint Size = 16u;
+		while (Size < 2u * SKeys.size()) Size <<= 1;
+		Mask = Size - 1u;
+
+		Keys.assign(Size, 0ull);
+		First.assign(Size, None);
+		Entries.resize(SKeys.size());
+
+		for (uint e = 0u; e < SKeys.size(); e++)
+		{
+			uint i = Hash(SKeys[e]);
+			while (First[i] != None && Keys[i] != SKeys[e]) i = (i + 1u) & Mask;
+			Keys[i] = SKeys[e];
+			Entries[e] = { SSteps[e], First[i] };
+			First[i] = e;
+		}
+	}
+
+	// Get a shared symmetry between the given spins (generated only the first time)
+	const PiecesSymmetry* PiecesSymmetry::Get(const Spn SFrom, const Spn STo)
+	{
+		std::lock_guard<std::mutex> guard(SymmetriesMutex);
+		for (const auto& S : Symmetries) if (S->From == SFrom && S->To == STo) return S->Valid ? S.get() : nullptr;
+		Symmetries.push_back(std::unique_ptr<PiecesSymmetry>(new PiecesSymmetry));
+		PiecesSymmetry& S = *Symmetries.back();
+		S.From = SFrom;
+		S.To = STo;
+		S.Valid = S.Update();
+		return S.Valid ? &S : nullptr;
+	}
+
+	// Generate the symmetry: the same steps are applied to a solved cube in both spins, and each piece slot in the first
+	// spin gives the image piece slot in the second spin (image candidates with inconsistent slots are discarded)
+	bool PiecesSymmetry::Update()
+	{
+		Cube CFrom, CTo; // Solved cubes with both spins
+		Stp s1, s2;
+		Cube::GetSpinsSteps(CFrom.GetSpin(), From, s1, s2);
+		CFrom.ApplyStep(s1);
+		CFrom.ApplyStep(s2);
+		Cube::GetSpinsSteps(CTo.GetSpin(), To, s1, s2);
+		CTo.ApplyStep(s1);
+		CTo.ApplyStep(s2);
+		if (CFrom.GetSpin() != From || CTo.GetSpin() != To) return false;
+
+		PiecesMoves MFrom, MTo;
+		if (!MFrom.Update(CFrom) || !MTo.Update(CTo)) return false;
+
+		SourceSteps[0] = Stp::NONE;
+		for (uint m = 1u; m <= 18u; m++)
+		{
+			uint n = 1u;
+			while (n <= 18u && !MTo.SameMovement(static_cast<Stp>(n), MFrom, static_cast<Stp>(m))) n++;
+			if (n > 18u) return false;
+			SourceSteps[m] = static_cast<Stp>(n);
+		}
+
+		bool ECand[12][12], CCand[8][8]; // Image candidates
+		uint8_t EMap[12][12][24], CMap[8][8][24]; // Image slots for each candidate
+		std::fill(&ECand[0][0], &ECand[0][0] + 12 * 12, true);
+		std::fill(&CCand[0][0], &CCand[0][0] + 8 * 8, true);
+		std::fill(&EMap[0][0][0], &EMap[0][0][0] + 12 * 12 * 24, PruningTable::Unknown);
+		std::fill(&CMap[0][0][0], &CMap[0][0][0] + 8 * 8 * 24, PruningTable::Unknown);
+
+		auto Complete = [&]() -> bool // Check if each piece has a single candidate with all his slots known
+		{
+			for (uint p = 0u; p < 12u; p++)
+				for (uint q = 0u; q < 12u; q++) if (ECand[p][q])
+					for (uint sl = 0u; sl < 24u; sl++) if (EMap[p][q][sl] == PruningTable::Unknown) return false;
+			for (uint p = 0u; p < 8u; p++)
+				for (uint q = 0u; q < 8u; q++) if (CCand[p][q])
+					for (uint sl = 0u; sl < 24u; sl++) if (CMap[p][q][sl] == PruningTable::Unknown) return false;
+			return true;
+		};
+
+		std::vector<std::pair<PiecesState, PiecesState>> Layer = { { PiecesState::Solved(), PiecesState::Solved() } }, NextLayer;
+		for (uint Depth = 0u; Depth <= 4u && !Complete(); Depth++)
+		{
+			for (const auto& L : Layer)
+			{
+				for (uint p = 0u; p < 12u; p++)
+					for (uint q = 0u; q < 12u; q++) if (ECand[p][q])
+					{
+						uint8_t& Slot = EMap[p][q][L.first.ESlots[p]];
+						if (Slot == PruningTable::Unknown) Slot = L.second.ESlots[q];
+						else if (Slot != L.second.ESlots[q]) ECand[p][q] = false;
+					}
+				for (uint p = 0u; p < 8u; p++)
+					for (uint q = 0u; q < 8u; q++) if (CCand[p][q])
+					{
+						uint8_t& Slot = CMap[p][q][L.first.CSlots[p]];
+						if (Slot == PruningTable::Unknown) Slot = L.second.CSlots[q];
+						else if (Slot != L.second.CSlots[q]) CCand[p][q] = false;
+					}
+			}
+
+			NextLayer.clear();
+			for (const auto& L : Layer)
+			{
+				for (uint m = 1u; m <= 18u; m++)
+				{
+					std::pair<PiecesState, PiecesState> NL = L;
+					MFrom.Apply(NL.first, static_cast<Stp>(m));
+					MTo.Apply(NL.second, static_cast<Stp>(m));
+					NextLayer.push_back(NL);
+				}
+			}
+			Layer.swap(NextLayer);
+		}
+		if (!Complete()) return false;
+
+		bool EUsed[12] = {}, CUsed[8] = {};
+		for (uint p = 0u; p < 12u; p++)
+		{
+			const uint q = static_cast<uint>(std::find(ECand[p], ECand[p] + 12, true) - ECand[p]);
+			if (q == 12u || std::count(ECand[p], ECand[p] + 12, true) != 1 || EUsed[q]) return false;
+			EUsed[q] = true;
+			EdgesImage[p] = static_cast<uint8_t>(q);
+			EdgesSource[q] = static_cast<uint8_t>(p);
+			for (uint sl = 0u; sl < 24u; sl++) EdgesSlots[p][sl] = EMap[p][q][sl];
+		}
+		for (uint p = 0u; p < 8u; p++)
+		{
+			const uint q = static_cast<uint>(std::find(CCand[p], CCand[p] + 8, true) - CCand[p]);
+			if (q == 8u || std::count(CCand[p], CCand[p] + 8, true) != 1 || CUsed[q]) return false;
+			CUsed[q] = true;
+			CornersImage[p] = static_cast<uint8_t>(q);
+			CornersSource[q] = static_cast<uint8_t>(p);
+			for (uint sl = 0u; sl < 24u; sl++) CornersSlots[p][sl] = CMap[p][q][sl];
+		}
+		return true;
+	}
+}
@@ -0,0 +1,201 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include "cube.h"
+#include "pruning.h"
+
+namespace grcube3
+{
+	// Pieces state for the bidirectional search: slot (position * directions + direction) for each edge and corner,
+	// and a bit for each edge position with an oriented edge
+	struct PiecesState
+	{
+		uint8_t ESlots[12], CSlots[8];
+		uint EO;
+
+		static PiecesState Solved(); // Solved pieces state (all edges oriented)
+	};
+
+	class PiecesSymmetry;
+
+	// Pieces to solve in a bidirectional search target (pieces in his solved position, and optionally all edges oriented)
+	struct BidirectionalTarget
+	{
+		std::vector<PruningPiece> Edges, Corners; // Pieces to solve (direction may be needed or not)
+		bool EO = false; // All edges must be oriented
+
+		const PiecesSymmetry* Sym = nullptr; // Symmetry to the canonical target orientation (nullptr if this is a canonical target)
+		uint Table = 0u; // Canonical target index (backward sequences table)
+
+		static constexpr uint PieceBits = 5u, EOBits = 12u; // Bits used in the key for each piece and for the orientation
+
+		// Set the target from the edges and corners solve masks, returns false if the masks check pieces partially
+		bool Set(const S64, const S64, const bool);
+
+		// Check if the target state can be coded in a 64 bits key
+		bool Fits() const { return (Edges.size() + Corners.size()) * PieceBits + (EO ? EOBits : 0u) <= 64u; }
+
+		// Fold the target into the canonical target with the given symmetry, returns false if the pieces don't match
+		bool Fold(const BidirectionalTarget&, const PiecesSymmetry*);
+
+		// Get the key for the target pieces in the given state (pieces not in the target are ignored)
+		// For a folded target the key is the canonical target key for the state seen in the canonical orientation
+		S64 GetKey(const PiecesState&) const;
+	};
+
+	// Single layer movements effect over the pieces state
+	// The movements are taken from the cube, so the spin is considered (U is not always the same layer)
+	class PiecesMoves
+	{
+	public:
+		bool Update(const Cube&); // Get the movements for the cube spin, returns false if the movements can't be represented
+
+		void Apply(PiecesState& S, const Stp Step) const // Apply a single layer movement to the pieces state
+		{
+			const uint m = static_cast<uint>(Step) - 1u;
+			for (uint n = 0u; n < 12u; n++) S.ESlots[n] = EdgesMovs[m][S.ESlots[n]];
+			for (uint n = 0u; n < 8u; n++) S.CSlots[n] = CornersMovs[m][S.CSlots[n]];
+			uint EO = 0u;
+			for (uint p = 0u; p < 12u; p++) if ((S.EO >> p) & 1u) EO |= 1u << EdgesPos[m][p];
+			S.EO = EO ^ EOFlips[m];
+		}
+
+		static PiecesState GetState(const Cube&); // Get the pieces state from the cube
+
+		// Check if a step has the same movement than the step in other movements (with other spin)
+		bool SameMovement(const Stp, const PiecesMoves&, const Stp) const;
+
+	private:
+		uint8_t EdgesMovs[18][24], CornersMovs[18][24]; // New slot for each slot
+		uint8_t EdgesPos[18][12]; // New position for each edge position
+		uint EOFlips[18]; // Edges positions with orientation changed (after the movement)
+
+		bool Check(const Cube&) const; // Check the movements with the given cube
+	};
+
+	// Cube symmetry (rotation) between two spins: a pieces state with the first spin is converted to the pieces state of
+	// the same cube seen with the second spin (each piece goes to his image piece in the rotated cube)
+	// A step applied to the rotated state is equivalent to the source step applied to the first state
+	class PiecesSymmetry
+	{
+	public:
+		// Get a shared symmetry between the given spins (generated only the first time), nullptr if it can't be generated
+		static const PiecesSymmetry* Get(const Spn, const Spn);
+
+		uint GetEdgeImage(const uint e) const { return EdgesImage[e]; } // Image edge for the given edge
+		uint GetCornerImage(const uint c) const { return CornersImage[c]; } // Image corner for the given corner
+		uint GetEdgeSource(const uint e) const { return EdgesSource[e]; } // Edge with the given image edge
+		uint GetCornerSource(const uint c) const { return CornersSource[c]; } // Corner with the given image corner
+
+		// Slot of the image piece for the given piece slot
+		uint8_t GetEdgeSlot(const uint e, const uint8_t Slot) const { return EdgesSlots[e][Slot]; }
+		uint8_t GetCornerSlot(const uint c, const uint8_t Slot) const { return CornersSlots[c][Slot]; }
+
+		// Step for the first state equivalent to the given step applied to the rotated state
+		Stp GetSourceStep(const Stp S) const { return SourceSteps[static_cast<uint>(S)]; }
+
+	private:
+		Spn From, To; // Spins
+		uint8_t EdgesImage[12], CornersImage[8], EdgesSource[12], CornersSource[8];
+		uint8_t EdgesSlots[12][24], CornersSlots[8][24];
+		Stp SourceSteps[19];
+
+		bool Valid; // The symmetry has been generated
+		bool Update(); // Generate the symmetry from the pieces movements in both spins
+
+		static std::vector<std::unique_ptr<PiecesSymmetry>> Symmetries; // Shared symmetries
+		static std::mutex SymmetriesMutex; // Mutex for shared symmetries
+	};
+
+	// Get the key for the target pieces in the given state
+	inline S64 BidirectionalTarget::GetKey(const PiecesState& S) const
+	{
+		S64 Key = EO ? S.EO : 0ull;
+		if (Sym == nullptr)
+		{
+			for (const auto& P : Edges)
+				Key = (Key << PieceBits) | (P.Direction ? S.ESlots[P.Position] : S.ESlots[P.Position] & 0x1Eu);
+			for (const auto& P : Corners)
+				Key = (Key << PieceBits) | (P.Direction ? S.CSlots[P.Position] : S.CSlots[P.Position] - S.CSlots[P.Position] % 3u);
+		}
+		else // Pieces slots in the canonical orientation
+		{
+			for (const auto& P : Edges)
+			{
+				const uint e = Sym->GetEdgeSource(P.Position);
+				const uint8_t Slot = Sym->GetEdgeSlot(e, S.ESlots[e]);
+				Key = (Key << PieceBits) | (P.Direction ? Slot : Slot & 0x1Eu);
+			}
+			for (const auto& P : Corners)
+			{
+				const uint c = Sym->GetCornerSource(P.Position);
+				const uint8_t Slot = Sym->GetCornerSlot(c, S.CSlots[c]);
+				Key = (Key << PieceBits) | (P.Direction ? Slot : Slot - Slot % 3u);
+			}
+		}
+		return Key;
+	}
+
+	// Table with the steps sequences that reach the target from a pieces state (backward half of the search)
+	// Open addressing hash table with the target keys, and a linked list of sequences for each key
+	class HalfSearchTable
+	{
+	public:
+		static constexpr uint MaxSteps = 6u; // Maximum steps in a sequence
+		static constexpr uint StepBits = 5u; // Bits for each step (single layer movements) in a packed sequence
+		static constexpr uint None = 0xFFFFFFFFu; // No entry
+
+		// Build the table from the keys and packed steps sequences (first step in the lower bits)
+		void Build(const std::vector<S64>&, const std::vector<uint>&);
+
+		// Get the first entry for the key (None if the key is not in the table)
+		uint Find(const S64 Key) const
+		{
+			if (First.empty()) return None;
+			for (uint i = Hash(Key); First[i] != None; i = (i + 1u) & Mask) if (Keys[i] == Key) return First[i];
+			return None;
+		}
+
+		uint GetNext(const uint e) const { return Entries[e].Next; } // Next entry with the same key
+		uint GetSteps(const uint e) const { return Entries[e].Steps; } // Packed steps of the entry
+
+		uint GetSize() const { return static_cast<uint>(Entries.size()); } // Number of sequences in the table
+
+		static Stp GetStep(const uint Steps, const uint n) { return static_cast<Stp>((Steps >> (n * StepBits)) & 0x1Fu); }
+
+	private:
+		struct Entry { uint Steps, Next; };
+
+		std::vector<S64> Keys; // Keys in the hash table
+		std::vector<uint> First; // First entry for each key
+		std::vector<Entry> Entries; // Sequences
+		uint Mask = 0u; // Hash table size - 1
+
+		uint Hash(const S64 Key) const { const S64 h = Key * 0x9E3779B97F4A7C15ull; return static_cast<uint>(h ^ (h >> 32)) & Mask; }
+	};
+}
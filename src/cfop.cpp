@@ -21,6 +21,7 @@
 */
 
 #include "cfop.h"
+#include "cube_batch.h"
 
 #include <chrono>
 #include <algorithm>
@@ -63,6 +64,12 @@ namespace grcube3
         }
 
         TimeCrosses = TimeF2L = TimeOLL = TimePLL = Time1LLL = TimeEOLL = TimeZBLL = 0.0f;
+        PoolTimeStart = ThreadPool::Get().GetSavedTime();
+        LookupsStart = LLIndex::GetLookups();
+        TimeLimit = 0.0;
+        Transpositions.Resize(0u);
+        Truncated = false;
+        ThreadsCrosses.clear();
         DepthCrosses = 0u;
 
         CrossLayers.clear();
@@ -75,11 +82,43 @@ namespace grcube3
     // Returns false if no crosses found
     bool CFOP::SearchCrosses(const uint MaxDepth, const uint MaxSolves)
 	{
+        StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
         const auto time_crosses_start = std::chrono::system_clock::now();
 
         DepthCrosses = MaxDepth >= 4 ? MaxDepth : 4u;
 
         DeepSearch DSCrosses(Scramble);
+        SetCrossesSearch(DSCrosses, DepthCrosses);
+
+        DSCrosses.SetDeadline(StageDeadline);
+        DSCrosses.SetTranspositionTable(&Transpositions);
+        DSCrosses.Run(Cores);
+        if (DSCrosses.IsTruncated()) Truncated = true;
+
+        Cores = DSCrosses.GetCoresUsed();
+        ThreadsCrosses = DSCrosses.GetThreadsReport();
+
+        EvaluateCrosses(DSCrosses.Solves, MaxSolves);
+
+        const std::chrono::duration<double> crosses_elapsed_seconds = std::chrono::system_clock::now() - time_crosses_start;
+        TimeCrosses = crosses_elapsed_seconds.count();
+
+        return !DSCrosses.Solves.empty();
+	}
+
+	// Search the crosses solves for many scrambles walking the search tree only once (the solves for each scramble are the same
+	// than in SearchCrosses), return the scrambles per second
+	double CFOP::SearchCrossesBatch(const std::vector<Algorithm>& Scrambles, const uint MaxDepth, std::vector<std::vector<Algorithm>>& Solves, const int Threads)
+	{
+		DeepSearch DSCrosses(Scrambles.empty() ? Algorithm() : Scrambles[0]); // The batch scrambles replace the search scramble
+		SetCrossesSearch(DSCrosses, MaxDepth >= 4 ? MaxDepth : 4u);
+		DSCrosses.RunBatch(Scrambles, Solves, Threads);
+		return DSCrosses.GetScramblesPerSecond();
+	}
+
+	// Set the crosses search pieces and levels for the given search depth
+	void CFOP::SetCrossesSearch(DeepSearch& DSCrosses, const uint Depth)
+	{
         DSCrosses.AddToOptionalPieces(Pgr::CROSS_U);
         DSCrosses.AddToOptionalPieces(Pgr::CROSS_D);
         DSCrosses.AddToOptionalPieces(Pgr::CROSS_F);
@@ -101,20 +140,11 @@ namespace grcube3
         
         DSCrosses.AddSearchLevel(L_Root); // Level 1 (two steps -DOUBLE- root algorithms)
         DSCrosses.AddSearchLevel(L_NoCheck); // Level 2
-        for (uint l = 3; l < DepthCrosses; l++) DSCrosses.AddSearchLevel(L_Check); // Levels 3 to CrossDepth
+        for (uint l = 3; l < Depth; l++) DSCrosses.AddSearchLevel(L_Check); // Levels 3 to CrossDepth
 
         DSCrosses.UpdateRootData();
-
-        DSCrosses.Run(Cores);
-
-        Cores = DSCrosses.GetCoresUsed();
-
-        EvaluateCrosses(DSCrosses.Solves, MaxSolves);
-
-        const std::chrono::duration<double> crosses_elapsed_seconds = std::chrono::system_clock::now() - time_crosses_start;
-        TimeCrosses = crosses_elapsed_seconds.count();
-
-        return !DSCrosses.Solves.empty();
+        DSCrosses.SetPruning(true); // Use pruning tables for the pieces to solve
+        DSCrosses.SetBidirectional(true); // Meet in the middle search (forwards from the scramble, backwards from the solved pieces)
 	}
 
     // Search the best crosses solve algorithms from an algorithms vector
@@ -143,6 +173,7 @@ namespace grcube3
     // Search the best F2L algorithms for the given cross
     void CFOP::SearchF2L()
     {
+        StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
         const auto time_F2L_start = std::chrono::system_clock::now();
 
         for (const auto CrossLayer : CrossLayers)
@@ -268,7 +299,10 @@ namespace grcube3
                     if (F2L4_IsSolved) DS_F2L.AddToMandatoryPieces(F2L4);
                     else DS_F2L.AddToOptionalPieces(F2L4);
 
+                    DS_F2L.SetDeadline(StageDeadline);
+                    DS_F2L.SetTranspositionTable(&Transpositions);
                     DS_F2L.Run(Cores);
+                    if (DS_F2L.IsTruncated()) Truncated = true;
 
                     Cores = DS_F2L.GetCoresUsed();
 
@@ -426,6 +460,7 @@ namespace grcube3
     // Last layer edges orientation search
     void CFOP::SearchEOLL()
     {
+        StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
         const auto time_EOLL_start = std::chrono::system_clock::now();
 
         const SearchUnit U_UR(SequenceType::SINGLE, Sst::SINGLE_UR);
@@ -482,7 +517,10 @@ namespace grcube3
 
                 DSEO.UpdateRootData();
 
+                DSEO.SetDeadline(StageDeadline);
+                DSEO.SetTranspositionTable(&Transpositions);
                 DSEO.Run(Cores);
+                if (DSEO.IsTruncated()) Truncated = true;
 
                 DSEO.EvaluateShortestResult(EOLL[CLI][n], true);
             }
@@ -854,23 +892,42 @@ namespace grcube3
         
         std::vector<std::pair<uint, Algorithm>> ScoredSolves;
 
-        for (const auto& s : Solves) // Check each solve to get the best one
+        // The solves are applied in batches, with the cross and F2L checks done for all the cubes in the batch
+        const LanesMask CrossMask(CrossPG), F2LMask_1(F2L_1), F2LMask_2(F2L_2), F2LMask_3(F2L_3), F2LMask_4(F2L_4);
+        CubeBatch Batch;
+        uint CrossSolved = 0u, F2LSolved_1 = 0u, F2LSolved_2 = 0u, F2LSolved_3 = 0u, F2LSolved_4 = 0u;
+
+        for (uint i = 0u; i < Solves.size(); i++) // Check each solve to get the best one
         {
+            const uint b = i % CubeBatch::MaxSize; // Solve position in the batch
+
+            if (b == 0u) // Next batch
+            {
+                const uint Valid = Batch.SetAlgorithms(CBase, Solves, i);
+                for (uint n = 0u; n < Batch.GetSize(); n++) // Algorithms not valid in byte lanes are applied with a cube
+                    if (((Valid >> n) & 1u) == 0u) Batch.SetAlgorithm(n, CBase, Solves[i + n]);
+                CrossSolved = Batch.IsSolved(CrossMask);
+                F2LSolved_1 = Batch.IsSolved(F2LMask_1);
+                F2LSolved_2 = Batch.IsSolved(F2LMask_2);
+                F2LSolved_3 = Batch.IsSolved(F2LMask_3);
+                F2LSolved_4 = Batch.IsSolved(F2LMask_4);
+            }
+
+            const Algorithm& s = Solves[i];
             Score = 0u;
 
-            Cube CheckCube = CBase;
-            CheckCube.ApplyAlgorithm(s);
+            if (CrossMandatory && !((CrossSolved >> b) & 1u)) continue;
 
-            if (CrossMandatory && !CheckCube.IsSolved(CrossPG)) continue;
+            const Cube CheckCube = Batch.GetCube(b);
 
             Score += (s.GetSize() > 50u ? 0u : 50u - s.GetSize()) * SolveSizeMagnitude;
             Score += s.GetSubjectiveScore();
 
             // Check F2L solves
-            if (CheckCube.IsSolved(F2L_1)) Score += SolveF2LMagnitude;
-            if (CheckCube.IsSolved(F2L_2)) Score += SolveF2LMagnitude;
-            if (CheckCube.IsSolved(F2L_3)) Score += SolveF2LMagnitude;
-            if (CheckCube.IsSolved(F2L_4)) Score += SolveF2LMagnitude;
+            if ((F2LSolved_1 >> b) & 1u) Score += SolveF2LMagnitude;
+            if ((F2LSolved_2 >> b) & 1u) Score += SolveF2LMagnitude;
+            if ((F2LSolved_3 >> b) & 1u) Score += SolveF2LMagnitude;
+            if ((F2LSolved_4 >> b) & 1u) Score += SolveF2LMagnitude;
 
             // Check both F2L pieces condition in the opposite layer
             const Lyr EndLayer = Cube::OppositeLayer(StartLayer);
@@ -1187,8 +1244,14 @@ namespace grcube3
         Report += "Crosses search time: " + std::to_string(GetTimeCrosses()) + " s\n";
         Report += "F2L search time: " + std::to_string(GetTimeF2L()) + " s\n";
         Report += "Last layer search time: " + std::to_string(GetTimeLL()) + " s\n";
+
+        Report += LLIndex::GetLookupsReport(LookupsStart);
+
         Report += "Threads used: " + std::to_string(GetCores() > 0 ? GetCores() : 0) +
                   " of " + std::to_string(DeepSearch::GetSystemCores()) + "\n";
+        Report += "Threads pool time saved: " + std::to_string(ThreadPool::Get().GetSavedTime() - PoolTimeStart) + " s\n";
+        if (IsTruncated()) Report += "Some searches were truncated by the time limit\n";
+        if (!ThreadsCrosses.empty()) Report += "Crosses search threads:\n" + ThreadsCrosses;
 
         return Report;
     }
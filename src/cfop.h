@@ -24,6 +24,7 @@
 
 #include "cube_definitions.h"
 #include "deep_search.h"
+#include "ll_index.h"
 
 namespace grcube3
 {
@@ -57,8 +58,20 @@ namespace grcube3
 		// Set the metric for evaluations
 		void SetMetric(const Metrics m) { Metric = m; }
 
+		// Set the time limit for each search stage in seconds (0 = no limit), a stage out of time keeps the solves found so far
+		void SetTimeLimit(const double t) { TimeLimit = t; }
+
+		// Set the transposition table size for the searches (2 ^ given bits slots, 0 = no transposition table)
+		void SetTranspositionTable(const uint b) { Transpositions.Resize(b); }
+
+		// Check if any search stage has been truncated by the time limit
+		bool IsTruncated() const { return Truncated; }
+
         // Solves searchs
         bool SearchCrosses(const uint, const uint = 1u); // Search best solves for given search depth and the maximun inspections, return false if no crosses found
+
+        // Search the crosses solves for many scrambles walking the search tree only once (for EvaluateCrosses), return the scrambles per second
+        static double SearchCrossesBatch(const std::vector<Algorithm>&, const uint, std::vector<std::vector<Algorithm>>&, const int = 0);
         void SearchF2L();
 		void SearchOLL();
 		void SearchPLL();
@@ -210,6 +223,13 @@ namespace grcube3
 		Metrics Metric; // Metric for measures
 
         double TimeCrosses, TimeF2L, TimeOLL, TimePLL, Time1LLL, TimeEOLL, TimeZBLL; // Times
+        double PoolTimeStart; // Threads pool saved time when the search was reset
+        LLIndex::Lookups LookupsStart; // Last layer recognition lookups when the search was reset
+        double TimeLimit; // Time limit for each search stage (seconds)
+        TranspositionTable Transpositions; // Transposition table reused by all the searches
+        std::chrono::steady_clock::time_point StageDeadline; // Deadline for the current search stage
+        bool Truncated; // Some search stage has been truncated by the time limit
+        std::string ThreadsCrosses; // Threads busy / idle times report for the crosses search
 
 		int Cores; // Cores to use in the search: -1 = no multithreading, 0 = all avaliable cores, other = use this amount of cores
 
@@ -220,5 +240,8 @@ namespace grcube3
 
 		// Check if in the given cross face the solve is OK
 		bool IsSolved(const Fce, const uint) const;
+
+		// Set the crosses search pieces and levels for the given search depth
+		static void SetCrossesSearch(DeepSearch&, const uint);
 	};
 }
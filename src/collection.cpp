@@ -24,9 +24,12 @@
 #include <iomanip>
 #include <fstream>
 #include <vector>
+#include <cstring>
+#include <cstdint>
 
 #include "collection.h"
 #include "cube.h"
+#include "mapped_file.h"
 #include "tinyxml2.h"
 
 using namespace tinyxml2;
@@ -89,6 +92,14 @@ namespace grcube3
         return !Data.empty();
     }
 
+    // Calculate the effects of the first algorithm of each case for the given spin
+    void Collection::UpdateEffects(const Spn sp) const
+    {
+        std::vector<CubeEffect>& SpinEffects = Effects->Effects[static_cast<int>(sp)];
+        SpinEffects.clear();
+        for (const auto& C : Data) SpinEffects.push_back(Cube::GetEffect(C.Algs.empty() ? Algorithm() : C.Algs.front(), sp));
+    }
+
     // Save a collection of algorithms to an XML file
     bool Collection::SaveXMLCollectionFile(const std::string& XMLFilename)
     {
@@ -122,6 +133,183 @@ namespace grcube3
         return col_xml.SaveFile(XMLFilename.c_str()) == XML_SUCCESS;
     }
 
+    // Compiled collection file (.ssmc), all values in the machine byte order:
+    //  Header: "SSMC", format version, CubeEffect size, cases number and spins with effects (0 or 24) as 32 bits values
+    //  Collection name and description (32 bits length and chars)
+    //  Cases: name (32 bits length and chars), 32 bits algorithms number and algorithms (32 bits length and a byte for each step)
+    //  Effects of the first algorithm of each case for each spin (CubeEffect structs from a 8 bytes aligned offset)
+    static const char CompiledMagic[4] = { 'S', 'S', 'M', 'C' };
+    static constexpr std::uint32_t CompiledVersion = 1u;
+
+    // Sequential reader for compiled files (all reads are checked against the file size)
+    class CompiledReader
+    {
+    public:
+        CompiledReader(const std::uint8_t* d, const std::size_t s) : Data(d), Size(s), Pos(0u) { }
+
+        bool Read(void* Dest, const std::size_t n)
+        {
+            if (n > Size - Pos) return false;
+            std::memcpy(Dest, Data + Pos, n);
+            Pos += n;
+            return true;
+        }
+
+        bool Read(std::uint32_t& v) { return Read(&v, sizeof(v)); }
+
+        bool Read(std::string& str)
+        {
+            std::uint32_t n;
+            if (!Read(n) || n > Size - Pos) return false;
+            str.assign(reinterpret_cast<const char*>(Data + Pos), n);
+            Pos += n;
+            return true;
+        }
+
+        bool Read(Algorithm& A)
+        {
+            std::uint32_t n;
+            if (!Read(n) || n > Size - Pos) return false;
+            A.Clear();
+            for (std::uint32_t i = 0u; i < n; i++)
+            {
+                if (Data[Pos + i] > static_cast<std::uint8_t>(Stp::PARENTHESIS_CLOSE_9_REP)) return false;
+                A.Append(static_cast<Stp>(Data[Pos + i]));
+            }
+            Pos += n;
+            return true;
+        }
+
+        void Align(const std::size_t a) { Pos = (Pos + a - 1u) / a * a; if (Pos > Size) Pos = Size; }
+
+    private:
+        const std::uint8_t* Data;
+        std::size_t Size, Pos;
+    };
+
+    // Load a collection of algorithms from the compiled file for the given XML file if it exists, else from the XML file
+    bool Collection::LoadCollectionFile(const std::string& XMLFilename)
+    {
+        return LoadCompiledCollectionFile(GetCompiledFilename(XMLFilename)) || LoadXMLCollectionFile(XMLFilename, true);
+    }
+
+    // Load a collection of algorithms from a compiled (binary) file, with the precomputed effects if available
+    bool Collection::LoadCompiledCollectionFile(const std::string& Filename)
+    {
+        Reset(); // Clear current collection
+
+        MappedFile File;
+        if (!File.Open(Filename)) return false;
+
+        CompiledReader Reader(File.GetData(), File.GetSize());
+
+        char Magic[4];
+        std::uint32_t Version, EffectSize, CasesNumber, Spins;
+        if (!Reader.Read(Magic, sizeof(Magic)) || std::memcmp(Magic, CompiledMagic, sizeof(Magic)) != 0 ||
+            !Reader.Read(Version) || Version != CompiledVersion || !Reader.Read(EffectSize) || EffectSize != sizeof(CubeEffect) ||
+            !Reader.Read(CasesNumber) || !Reader.Read(Spins) || (Spins != 0u && Spins != 24u) ||
+            !Reader.Read(Name) || !Reader.Read(Description))
+        {
+            Reset();
+            return false;
+        }
+
+        Data.reserve(CasesNumber);
+        for (std::uint32_t c = 0u; c < CasesNumber; c++)
+        {
+            Case AuxCase;
+            std::uint32_t AlgsNumber;
+            if (!Reader.Read(AuxCase.Name) || !Reader.Read(AlgsNumber))
+            {
+                Reset();
+                return false;
+            }
+            AuxCase.Algs.resize(AlgsNumber);
+            for (auto& A : AuxCase.Algs)
+            {
+                if (!Reader.Read(A))
+                {
+                    Reset();
+                    return false;
+                }
+            }
+            Data.push_back(AuxCase);
+        }
+
+        if (Spins > 0u) // Precomputed effects
+        {
+            Reader.Align(8u);
+            std::array<std::vector<CubeEffect>, 24u> FileEffects;
+            for (auto& SpinEffects : FileEffects)
+            {
+                SpinEffects.resize(CasesNumber);
+                if (!Reader.Read(SpinEffects.data(), CasesNumber * sizeof(CubeEffect)))
+                {
+                    Reset();
+                    return false;
+                }
+            }
+            for (uint s = 0u; s < 24u; s++)
+                std::call_once(Effects->Flags[s], [this, s, &FileEffects]() { Effects->Effects[s].swap(FileEffects[s]); });
+        }
+
+        return !Data.empty();
+    }
+
+    // Save a collection of algorithms to a compiled (binary) file (optionally with the effects for all spins)
+    bool Collection::SaveCompiledCollectionFile(const std::string& Filename, const bool WithEffects) const
+    {
+        std::ofstream f(Filename, std::ios::binary | std::ios::trunc);
+        if (!f.is_open()) return false;
+
+        auto Write32 = [&f](const std::uint32_t v) { f.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+        auto WriteString = [&f, &Write32](const std::string& str) { Write32(static_cast<std::uint32_t>(str.size())); f.write(str.data(), str.size()); };
+
+        f.write(CompiledMagic, sizeof(CompiledMagic));
+        Write32(CompiledVersion);
+        Write32(static_cast<std::uint32_t>(sizeof(CubeEffect)));
+        Write32(static_cast<std::uint32_t>(Data.size()));
+        Write32(WithEffects ? 24u : 0u);
+        WriteString(Name);
+        WriteString(Description);
+
+        for (const auto& C : Data)
+        {
+            WriteString(C.Name);
+            Write32(static_cast<std::uint32_t>(C.Algs.size()));
+            for (const auto& A : C.Algs)
+            {
+                Write32(A.GetSize());
+                for (uint n = 0u; n < A.GetSize(); n++) f.put(static_cast<char>(A.At(n)));
+            }
+        }
+
+        if (WithEffects)
+        {
+            while (f.tellp() % 8 != 0) f.put(0);
+            for (uint s = 0u; s < 24u; s++)
+                for (uint c = 0u; c < GetCasesNumber(); c++)
+                    f.write(reinterpret_cast<const char*>(&GetEffect(c, static_cast<Spn>(s))), sizeof(CubeEffect));
+        }
+
+        return f.good();
+    }
+
+    // Convert an XML collection file to his compiled file
+    bool Collection::CompileXMLCollectionFile(const std::string& XMLFilename)
+    {
+        Collection Col;
+        return Col.LoadXMLCollectionFile(XMLFilename, true) && Col.SaveCompiledCollectionFile(GetCompiledFilename(XMLFilename));
+    }
+
+    // Compiled file name for an XML file name (.ssmc extension)
+    std::string Collection::GetCompiledFilename(const std::string& XMLFilename)
+    {
+        const std::size_t Dot = XMLFilename.find_last_of('.');
+        if (Dot != std::string::npos && XMLFilename.substr(Dot) == ".xml") return XMLFilename.substr(0u, Dot) + ".ssmc";
+        return XMLFilename + ".ssmc";
+    }
+
     // Check if two last layer algorithms are equivalent
     bool Collection::EquivalentLLAlgorithms(const Algorithm& A, const Algorithm& B)
     {
@@ -24,6 +24,9 @@
 
 #include <string>
 #include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
 
 #include "cube_definitions.h"
 #include "algorithm.h"
@@ -40,25 +43,39 @@ namespace grcube3
     class Collection // Algorithms collection class
 	{
 	public:
-		Collection() { }
-        Collection(const std::string& s) { LoadXMLCollectionFile(s, true); } // Initialize algorithms collection
+		Collection() { Effects = std::make_shared<EffectsCache>(); }
+        Collection(const std::string& s) { LoadCollectionFile(s); } // Initialize algorithms collection
         ~Collection() { } // Destructor
 		
 		Algorithm& operator[](const uint cn) { return GetAlgorithm(cn); }
+		const Algorithm& operator[](const uint cn) const { return GetAlgorithm(cn); }
 
-		void AddData(const Case& CData) { Data.push_back(CData); }
+		void AddData(const Case& CData) { Data.push_back(CData); Effects = std::make_shared<EffectsCache>(); }
 		
-		void Reset() { Name.clear(); Description.clear(); Data.clear(); }
+		void Reset() { Name.clear(); Description.clear(); Data.clear(); Effects = std::make_shared<EffectsCache>(); }
 		uint GetCasesNumber() const { return static_cast<uint>(Data.size()); }
-		std::string GetCaseName(const uint cp) // Return case name
+		std::string GetCaseName(const uint cp) const // Return case name
 		{
 			if (cp < Data.size()) return Data[cp].Name;
 			std::string s_Empty = "";
 			return s_Empty;
 		}
 
+		// Return all algorithms for the given case index
+		const std::vector<Algorithm>& GetCaseAlgorithms(const uint cn) const { return Data[cn].Algs; }
+
 		// Return first algorithm for the given case index
 		Algorithm& GetAlgorithm(const uint cn) { return Data[cn].Algs.front(); }
+		const Algorithm& GetAlgorithm(const uint cn) const { return Data[cn].Algs.front(); }
+
+		// Return the effect of the first algorithm for the given case index applied from the given spin
+		// The effects of all cases are calculated the first time a spin is required
+		const CubeEffect& GetEffect(const uint cn, const Spn sp) const
+		{
+			const int s = static_cast<int>(sp);
+			std::call_once(Effects->Flags[s], [this, s]() { UpdateEffects(static_cast<Spn>(s)); });
+			return Effects->Effects[s][cn];
+		}
 
 		// Load a collection of algorithms from an XML file (optionally clean y an U steps from the start/end)
 		bool LoadXMLCollectionFile(const std::string&, const bool = false); 
@@ -66,6 +83,22 @@ namespace grcube3
 		// Save a collection of algorithms to an XML file
 		bool SaveXMLCollectionFile(const std::string&);
 
+		// Load a collection of algorithms from the compiled file for the given XML file if it exists, else from the XML file
+		// (cleaning y an U steps from the start/end, compiled files are saved from XML files loaded in this way)
+		bool LoadCollectionFile(const std::string&);
+
+		// Load a collection of algorithms from a compiled (binary) file, with the precomputed effects if available
+		bool LoadCompiledCollectionFile(const std::string&);
+
+		// Save a collection of algorithms to a compiled (binary) file (optionally with the effects for all spins)
+		bool SaveCompiledCollectionFile(const std::string&, const bool = true) const;
+
+		// Convert an XML collection file to his compiled file
+		static bool CompileXMLCollectionFile(const std::string&);
+
+		// Compiled file name for an XML file name (.ssmc extension)
+		static std::string GetCompiledFilename(const std::string&);
+
 		// Check if two last layer algorithms are equivalent
         static bool EquivalentLLAlgorithms(const Algorithm&, const Algorithm&);
 
@@ -75,5 +108,15 @@ namespace grcube3
         std::string Name; // Algorithms collection name
         std::string Description; // Algorithms collection description
         std::vector<Case> Data; // Algorithms collection data (cases)
+
+		// Algorithms effects for each spin (shared between copies of the collection, renewed when the cases change)
+		struct EffectsCache
+		{
+			std::array<std::vector<CubeEffect>, 24u> Effects;
+			std::array<std::once_flag, 24u> Flags;
+		};
+		std::shared_ptr<EffectsCache> Effects;
+
+		void UpdateEffects(const Spn) const; // Calculate the algorithms effects for the given spin
 	};
 }
@@ -0,0 +1,378 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#include <algorithm>
+
+#include "coordinates.h"
+
+namespace grcube3
+{
+	std::vector<std::unique_ptr<Coordinate>> Coordinate::Coordinates;
+	std::mutex Coordinate::CoordinatesMutex;
+
+	// Corners positions where the FB and RL directions are swapped to get the corner twist (the twists sum is always
+	// a multiple of three)
+	static constexpr bool SwappedTwist[8] = { true, false, true, false, false, true, false, true };
+
+	// Corner twist from the corner direction in the given position (and the corner direction from the twist)
+	static uint GetTwist(const uint p, const uint d) { return SwappedTwist[p] && d != 0u ? 3u - d : d; }
+
+	// Binomial coefficient (0 if k > n)
+	static uint Binomial(const uint n, const uint k)
+	{
+		if (k > n) return 0u;
+		uint b = 1u;
+		for (uint i = 1u; i <= k; i++) b = b * (n - k + i) / i;
+		return b;
+	}
+
+	// Pieces used by each coordinate type (orientation coordinates don't use pieces, and the directions are not
+	// used in the edges set coordinate)
+	static std::vector<PruningPiece> GetUsedPieces(const Crd Type, const std::vector<PruningPiece>& PList)
+	{
+		std::vector<PruningPiece> UsedPieces;
+		if (Type == Crd::EO || Type == Crd::CO) return UsedPieces;
+		for (const auto& P : PList) UsedPieces.push_back({ P.Position, Type == Crd::EDGES_SET ? false : P.Direction });
+		return UsedPieces;
+	}
+
+	// Coordinate constructor
+	Coordinate::Coordinate(const Crd CType, const std::vector<PruningPiece>& PList)
+	{
+		Type = CType;
+		Pieces = GetUsedPieces(Type, PList);
+
+		const uint NPieces = static_cast<uint>(Pieces.size());
+		switch (Type)
+		{
+		case Crd::EO: Size = 2048u; break;
+		case Crd::CO: Size = 2187u; break;
+		case Crd::EDGES_SET: Size = Binomial(12u, NPieces); break;
+		case Crd::EDGES:
+		case Crd::CORNERS:
+			Size = 1u;
+			for (uint n = 0u; n < NPieces; n++)
+			{
+				Size *= (Type == Crd::EDGES ? 12u : 8u) - n;
+				if (Pieces[n].Direction) Size *= Type == Crd::EDGES ? 2u : 3u;
+			}
+			break;
+		default: Size = 1u; break;
+		}
+
+		Solved = Get(Cube());
+	}
+
+	// Build the movements table (only the first time)
+	void Coordinate::PrepareMoves() const
+	{
+		std::call_once(MovesFlag, [this]() { const_cast<Coordinate*>(this)->BuildMoves(); });
+	}
+
+	// Build the movements table
+	void Coordinate::BuildMoves()
+	{
+		const uint NPieces = static_cast<uint>(Pieces.size());
+		Moves.resize(static_cast<std::size_t>(Size) * 18u);
+		if (Type == Crd::EO || Type == Crd::CO) // Small coordinates, the movements are applied to a cube
+		{
+			Cube C;
+			S64 Edges, Corners;
+			for (uint c = 0u; c < Size; c++)
+			{
+				Set(c, Edges, Corners);
+				for (uint m = 0u; m < 18u; m++)
+				{
+					C.SetStatus(Edges, Corners);
+					C.ApplyStep(static_cast<Stp>(m + 1u)); // Single layer movements in the default spin
+					Moves[c * 18u + m] = Get(C);
+				}
+			}
+			return;
+		}
+
+		// The pieces slots are moved with the pruning tables movements: the positions are moved once for all the
+		// directions values, and each direction is moved as a digit of the directions part of the coordinate
+		const uint NDirs = Type == Crd::CORNERS ? 3u : 2u;
+		uint DirsSize = 1u, Weights[12];
+		for (uint n = NPieces; n-- > 0u; )
+		{
+			Weights[n] = DirsSize;
+			if (Pieces[n].Direction) DirsSize *= NDirs;
+		}
+		std::vector<uint8_t> DirsDigits(DirsSize * NPieces); // Direction of each piece for each directions value
+		for (uint Dirs = 0u; Dirs < DirsSize; Dirs++)
+			for (uint n = 0u; n < NPieces; n++) DirsDigits[Dirs * NPieces + n] = static_cast<uint8_t>(Dirs / Weights[n] % NDirs);
+
+		uint Slots[12], MovedSlots[12], MovedDirs[12][3];
+		for (uint r = 0u; r < Size; r += DirsSize)
+		{
+			GetSlots(r, Slots); // Directions are zero
+			for (uint m = 0u; m < 18u; m++)
+			{
+				const uint8_t* Movs = Type == Crd::CORNERS ? PruningTable::GetCornersMovs(m) : PruningTable::GetEdgesMovs(m);
+				for (uint n = 0u; n < NPieces; n++)
+				{
+					MovedSlots[n] = Movs[Slots[n]] / NDirs * NDirs;
+					for (uint d = 0u; d < NDirs; d++) MovedDirs[n][d] = Movs[Slots[n] + d] % NDirs * Weights[n];
+				}
+				const uint Moved = GetCoordinate(MovedSlots);
+				for (uint Dirs = 0u; Dirs < DirsSize; Dirs++)
+				{
+					const uint8_t* Digits = &DirsDigits[Dirs * NPieces];
+					uint c = Moved;
+					for (uint n = 0u; n < NPieces; n++) if (Pieces[n].Direction) c += MovedDirs[n][Digits[n]];
+					Moves[(r + Dirs) * 18u + m] = c;
+				}
+			}
+		}
+	}
+
+	// Get the coordinate from the edges and corners status
+	uint Coordinate::Get(const S64 Edges, const S64 Corners) const
+	{
+		uint c = 0u;
+		switch (Type)
+		{
+		case Crd::EO:
+			for (uint p = 0u; p < 11u; p++) c |= static_cast<uint>((Edges >> (48u + p)) & 0x1u) << p;
+			return c;
+
+		case Crd::CO:
+			for (uint p = 7u; p-- > 0u; ) c = c * 3u + GetTwist(p, static_cast<uint>((Corners >> (8u * p + 4u)) & 0x3u));
+			return c;
+
+		case Crd::EDGES_SET:
+		case Crd::EDGES:
+		case Crd::CORNERS:
+		{
+			uint8_t PiecesSlots[12];
+			if (Type == Crd::CORNERS) PruningTable::GetCornersSlots(Corners, PiecesSlots);
+			else PruningTable::GetEdgesSlots(Edges, PiecesSlots);
+
+			uint Slots[12], n = 0u;
+			for (const auto& P : Pieces) Slots[n++] = PiecesSlots[P.Position];
+			return GetCoordinate(Slots);
+		}
+
+		default: return 0u;
+		}
+	}
+
+	// Get the coordinate from the coordinate pieces slots (position * directions + direction)
+	uint Coordinate::GetCoordinate(const uint* Slots) const
+	{
+		const uint NPieces = static_cast<uint>(Pieces.size());
+		uint c = 0u;
+
+		if (Type == Crd::EDGES_SET) // Combinatorial number for the sorted positions
+		{
+			uint SetMask = 0u;
+			for (uint n = 0u; n < NPieces; n++) SetMask |= 1u << (Slots[n] / 2u);
+			uint k = 0u;
+			for (uint p = 0u; p < 12u; p++) if ((SetMask >> p) & 0x1u) c += Binomial(p, ++k);
+			return c;
+		}
+
+		// Partial permutation rank, then the directions
+		const uint NPos = Type == Crd::EDGES ? 12u : 8u, NDirs = Type == Crd::EDGES ? 2u : 3u;
+		uint Used = 0u;
+		for (uint n = 0u; n < NPieces; n++)
+		{
+			const uint Pos = Slots[n] / NDirs;
+			c = c * (NPos - n) + Pos - static_cast<uint>(__builtin_popcount(Used & ((1u << Pos) - 1u)));
+			Used |= 1u << Pos;
+		}
+		for (uint n = 0u; n < NPieces; n++) if (Pieces[n].Direction) c = c * NDirs + Slots[n] % NDirs;
+		return c;
+	}
+
+	// Get the coordinate pieces slots from the coordinate (the edges set positions are sorted, the directions not
+	// included in the coordinate are zero)
+	void Coordinate::GetSlots(uint c, uint* Slots) const
+	{
+		const uint NPieces = static_cast<uint>(Pieces.size());
+
+		if (Type == Crd::EDGES_SET) // Sorted positions from the combinatorial number
+		{
+			for (uint k = NPieces; k > 0u; k--)
+			{
+				uint p = k - 1u;
+				while (Binomial(p + 1u, k) <= c) p++;
+				c -= Binomial(p, k);
+				Slots[k - 1u] = p * 2u;
+			}
+			return;
+		}
+
+		// Positions and directions from the partial permutation rank
+		const uint NPos = Type == Crd::EDGES ? 12u : 8u, NDirs = Type == Crd::EDGES ? 2u : 3u;
+		uint Dirs[12] = { 0u }, Digits[12];
+		for (uint n = NPieces; n-- > 0u; ) if (Pieces[n].Direction) { Dirs[n] = c % NDirs; c /= NDirs; }
+		for (uint n = NPieces; n-- > 0u; ) { Digits[n] = c % (NPos - n); c /= NPos - n; }
+		uint Used = 0u;
+		for (uint n = 0u; n < NPieces; n++)
+		{
+			uint Pos = 0u;
+			for (uint Free = 0u; ; Pos++) if (!((Used >> Pos) & 0x1u) && Free++ == Digits[n]) break;
+			Slots[n] = Pos * NDirs + Dirs[n];
+			Used |= 1u << Pos;
+		}
+	}
+
+	// Get an edges and corners status with the given coordinate
+	void Coordinate::Set(uint c, S64& Edges, S64& Corners) const
+	{
+		const Cube SolvedCube;
+		Edges = SolvedCube.GetEdgesStatus();
+		Corners = SolvedCube.GetCornersStatus();
+
+		switch (Type)
+		{
+		case Crd::EO:
+		{
+			uint Parity = 0u;
+			for (uint p = 0u; p < 11u; p++)
+			{
+				const uint d = (c >> p) & 0x1u;
+				Edges |= static_cast<S64>(d) << (48u + p);
+				Parity ^= d;
+			}
+			Edges |= static_cast<S64>(Parity) << 59u;
+			return;
+		}
+
+		case Crd::CO:
+		{
+			uint Sum = 0u;
+			for (uint p = 0u; p < 7u; p++)
+			{
+				const uint t = c % 3u;
+				c /= 3u;
+				Corners |= static_cast<S64>(GetTwist(p, t)) << (8u * p + 4u);
+				Sum += t;
+			}
+			Corners |= static_cast<S64>(GetTwist(7u, (3u - Sum % 3u) % 3u)) << 60u;
+			return;
+		}
+
+		default: break;
+		}
+
+		const bool IsEdges = Type != Crd::CORNERS;
+		const uint NPos = IsEdges ? 12u : 8u, NDirs = IsEdges ? 2u : 3u, NPieces = static_cast<uint>(Pieces.size());
+		uint PieceAt[12], DirAt[12], Positions[12], Slots[12];
+
+		GetSlots(c, Slots);
+		for (uint n = 0u; n < NPieces; n++)
+		{
+			Positions[n] = Slots[n] / NDirs;
+			DirAt[n] = Slots[n] % NDirs;
+		}
+
+		// Coordinate pieces (the edges set pieces in order), then the other pieces in the free positions
+		std::vector<uint> PList;
+		for (const auto& P : Pieces) PList.push_back(P.Position);
+		if (Type == Crd::EDGES_SET) std::sort(PList.begin(), PList.end());
+
+		uint Placed = 0u, Dirs[12];
+		for (uint p = 0u; p < NPos; p++) PieceAt[p] = NPos;
+		for (uint n = 0u; n < NPieces; n++)
+		{
+			PieceAt[Positions[n]] = PList[n];
+			Dirs[Positions[n]] = Type == Crd::EDGES_SET ? 0u : DirAt[n];
+			Placed |= 1u << PList[n];
+		}
+		for (uint p = 0u, Piece = 0u; p < NPos; p++)
+		{
+			if (PieceAt[p] != NPos) continue;
+			while ((Placed >> Piece) & 0x1u) Piece++;
+			PieceAt[p] = Piece++;
+			Dirs[p] = 0u;
+		}
+
+		if (IsEdges)
+		{
+			Edges = 0ull;
+			for (uint p = 0u; p < 12u; p++) Edges |= (static_cast<S64>(PieceAt[p]) << (4u * p)) | (static_cast<S64>(Dirs[p]) << (48u + p));
+		}
+		else
+		{
+			Corners = 0ull;
+			for (uint p = 0u; p < 8u; p++) Corners |= (static_cast<S64>(PieceAt[p]) << (8u * p)) | (static_cast<S64>(Dirs[p]) << (8u * p + 4u));
+		}
+	}
+
+	// Get a cube with the given coordinate
+	Cube Coordinate::GetCube(const uint c) const
+	{
+		S64 Edges, Corners;
+		Set(c, Edges, Corners);
+		Cube C;
+		C.SetStatus(Edges, Corners);
+		return C;
+	}
+
+	// Get a shared coordinate (the coordinate is generated only the first time)
+	const Coordinate* Coordinate::Get(const Crd CType, const std::vector<PruningPiece>& PList)
+	{
+		const std::vector<PruningPiece> UsedPieces = GetUsedPieces(CType, PList);
+
+		std::lock_guard<std::mutex> guard(CoordinatesMutex);
+		for (const auto& C : Coordinates) if (C->Type == CType && C->Pieces == UsedPieces) return C.get();
+		Coordinates.push_back(std::unique_ptr<Coordinate>(new Coordinate(CType, UsedPieces)));
+		return Coordinates.back().get();
+	}
+
+	// Get the coordinates for groups of pieces positions
+	void Coordinate::GetCoordinates(const std::vector<Pgr>& Groups, std::vector<const Coordinate*>& CList)
+	{
+		std::vector<Pcp> Positions;
+		Cube::AddToPositionsList(Groups, Positions);
+
+		std::vector<PruningPiece> EList, CnList;
+		for (const auto Pos : Positions)
+		{
+			const uint p = static_cast<uint>(Pos);
+			if (p >= static_cast<uint>(Pcp::First_Edge) && p <= static_cast<uint>(Pcp::Last_Edge))
+				EList.push_back({ p - static_cast<uint>(Pcp::First_Edge), true });
+			else if (p >= static_cast<uint>(Pcp::First_Corner) && p <= static_cast<uint>(Pcp::Last_Corner))
+				CnList.push_back({ p - static_cast<uint>(Pcp::First_Corner), true });
+		}
+
+		for (const auto* L : { &EList, &CnList })
+		{
+			std::vector<PruningPiece> PList; // Pieces without repetitions, split in coordinates with the maximum pieces
+			for (const auto& P : *L)
+			{
+				if (std::find(PList.begin(), PList.end(), P) != PList.end()) continue;
+				PList.push_back(P);
+			}
+			for (std::size_t n = 0u; n < PList.size(); n += MaxPieces)
+			{
+				const std::vector<PruningPiece> Chunk(PList.begin() + n, PList.begin() + std::min(n + MaxPieces, PList.size()));
+				CList.push_back(Get(L == &EList ? Crd::EDGES : Crd::CORNERS, Chunk));
+			}
+		}
+	}
+}
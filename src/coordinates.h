@@ -0,0 +1,108 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <memory>
+
+#include "cube.h"
+#include "pruning.h"
+
+namespace grcube3
+{
+	// Coordinate types
+	enum class Crd
+	{
+		EO, // Edges orientation (11 edges, the last one is given by the parity): 2048 values
+		CO, // Corners orientation (7 corners, the last one is given by the twist sum): 2187 values
+		EDGES_SET, // Positions of a set of edges without order (the slice coordinate for the E layer edges): C(12, n) values
+		EDGES, // Positions (and directions if needed) of a list of edges: 12! / (12 - n)! (* 2^n) values
+		CORNERS // Positions (and directions if needed) of a list of corners: 8! / (8 - n)! (* 3^n) values
+	};
+
+	// Compact index for a part of the cube state (pieces relative to the centers, as the edges and corners status),
+	// with the movements table for the single layer movements
+	class Coordinate
+	{
+	public:
+		// Coordinate constructor (the pieces are not used for the orientation coordinates)
+		Coordinate(const Crd, const std::vector<PruningPiece>& = {});
+
+		Crd GetType() const { return Type; }
+		const std::vector<PruningPiece>& GetPieces() const { return Pieces; }
+		uint GetSize() const { return Size; } // Number of coordinate values
+		uint GetSolved() const { return Solved; } // Coordinate for the solved cube
+
+		// Get the coordinate from the edges and corners status
+		uint Get(const S64, const S64) const;
+		uint Get(const Cube& C) const { return Get(C.GetEdgesStatus(), C.GetCornersStatus()); }
+
+		// Get an edges and corners status with the given coordinate: the pieces not in the coordinate are placed in the
+		// free positions in order, with the default direction (the status can have a wrong parity)
+		void Set(const uint, S64&, S64&) const;
+		Cube GetCube(const uint) const;
+
+		// Build the movements table, needed before Move and ApplyStep (the table is built only the first time, so a
+		// coordinate used only to read a loaded distance table doesn't build it)
+		void PrepareMoves() const;
+
+		// Coordinate after a single layer movement (0 to 17, same order than in Stp enumeration, default spin)
+		uint Move(const uint c, const uint m) const { return Moves[c * 18u + m]; }
+
+		// Coordinate after a step in the given spin (the spin is updated)
+		uint ApplyStep(uint c, const Stp s, Spn& sp) const
+		{
+			const Cube::SpinStep& SS = Cube::GetSpinSteps()[static_cast<int>(sp)][static_cast<int>(s)];
+			for (uint n = 0u; n < SS.Count; n++) c = Move(c, SS.Moves[n]);
+			sp = SS.Spin;
+			return c;
+		}
+
+		// Get a shared coordinate (generated only the first time, without the movements table)
+		static const Coordinate* Get(const Crd, const std::vector<PruningPiece>& = {});
+
+		// Get the coordinates for groups of pieces positions: edges and corners lists with pieces directions, split as
+		// the pruning tables (the groups are solved when all coordinates are solved)
+		static void GetCoordinates(const Pgr G, std::vector<const Coordinate*>& CList) { GetCoordinates(std::vector<Pgr>{ G }, CList); }
+		static void GetCoordinates(const std::vector<Pgr>&, std::vector<const Coordinate*>&);
+
+		static constexpr uint MaxPieces = PruningTable::MaxPieces; // Maximum pieces in a group coordinate
+
+	private:
+		Crd Type;
+		std::vector<PruningPiece> Pieces; // Coordinate pieces (index of the piece and solved position)
+		uint Size, Solved;
+		std::vector<uint> Moves; // Movements table (18 movements for each coordinate)
+		mutable std::once_flag MovesFlag; // Flag for build the movements table once
+
+		void BuildMoves(); // Build the movements table
+
+		uint GetCoordinate(const uint*) const; // Coordinate from the pieces slots (position * directions + direction)
+		void GetSlots(uint, uint*) const; // Pieces slots from the coordinate
+
+		static std::vector<std::unique_ptr<Coordinate>> Coordinates; // Shared coordinates
+		static std::mutex CoordinatesMutex; // Mutex for shared coordinates
+	};
+}
@@ -20,21 +20,30 @@
     grvigo@hotmail.com
 */
 
+#include <cassert>
+#include <chrono>
+
 #include "cube.h"
+#include "ll_index.h"
 
 namespace grcube3
 {
     const std::array<Lyr, 6u> Cube::ExtLayers = { Lyr::U, Lyr::D, Lyr::F, Lyr::B, Lyr::R, Lyr::L }; // External layers
 
-	// Load algorithms collections needed
-	const Collection Cube::OLL_Algorithms("OLL.xml");
-    const Collection Cube::PLL_Algorithms("PLL.xml");
-    const Collection Cube::Algorithms_1LLL("1LLL.xml");
-    const Collection Cube::ZBLL_Algorithms("ZBLL.xml");
-    const Collection Cube::OCLL_Algorithms("OCLL.xml");
-    const Collection Cube::CMLL_Algorithms("CMLL.xml");
-	const Collection Cube::COLL_Algorithms("COLL.xml");
-	const Collection Cube::EPLL_Algorithms("EPLL.xml");
+	// Algorithms collections, loaded the first time a method needs them
+	static void LoadAlgorithms(Collection& Col, const std::string& Filename) { Col.LoadCollectionFile(Filename); }
+
+	const LazyFile<Collection> Cube::AlgSetsCollections[8] =
+	{
+		{ "1LLL.xml", LoadAlgorithms },
+		{ "OLL.xml", LoadAlgorithms },
+		{ "PLL.xml", LoadAlgorithms },
+		{ "ZBLL.xml", LoadAlgorithms },
+		{ "OCLL.xml", LoadAlgorithms },
+		{ "CMLL.xml", LoadAlgorithms },
+		{ "COLL.xml", LoadAlgorithms },
+		{ "EPLL.xml", LoadAlgorithms }
+	};
 	
     // Arrays to follow spins when a cube has a turn
 
@@ -976,14 +985,166 @@ namespace grcube3
     // If there are parentheses with more than one repetitions returns false and the cube will be in an undefined state!
     bool Cube::ApplyAlgorithm(const Algorithm& A)
     {
+        const SpinStepsTable& SpinSteps = GetSpinSteps();
+
         // Apply movements (steps)
-        for (uint n = 0u; n < A.GetSize(); n++) if(!ApplyStep(A.At(n))) return false;
+        for (uint n = 0u; n < A.GetSize(); n++)
+        {
+            const SpinStep& SS = SpinSteps[static_cast<int>(spin)][static_cast<int>(A.At(n))];
+            if (!SS.Valid) return false;
+            ApplySpinStep(SS);
+        }
         return true;
     }
 
+    // Get the pieces effect of an algorithm applied from the given spin
+    // The algorithm is applied to a cube with all pieces in direction 0 and to a cube with all corners in direction 1;
+    // a movement changes the directions with a permutation, so the third corner direction is the remaining one
+    CubeEffect Cube::GetEffect(const Algorithm& A, const Spn S)
+    {
+        CubeEffect E;
+        Cube C0, C1;
+        C0.spin = C1.spin = E.Start = S;
+        C1.corners = CMASK_SOLVED | 0x1010101010101010ull;
+
+        E.Valid = C0.ApplyAlgorithm(A);
+        C1.ApplyAlgorithm(A);
+        E.End = C0.spin;
+
+        for (uint p = 0u; p < 12u; p++)
+        {
+            const uint e = (C0.edges >> (4u * p)) & 0xFu, d = (C0.edges >> (48u + p)) & 0x1u;
+            E.Edges[e][0] = static_cast<uint8_t>(p | (d << 4));
+            E.Edges[e][1] = static_cast<uint8_t>(p | ((d ^ 1u) << 4));
+        }
+        for (uint p = 0u; p < 8u; p++)
+        {
+            const uint c = (C0.corners >> (8u * p)) & 0x7u,
+                       d0 = (C0.corners >> (8u * p + 4u)) & 0x3u, d1 = (C1.corners >> (8u * p + 4u)) & 0x3u;
+            E.Corners[c][0] = static_cast<uint8_t>(p | (d0 << 4));
+            E.Corners[c][1] = static_cast<uint8_t>(p | (d1 << 4));
+            E.Corners[c][2] = static_cast<uint8_t>(p | ((3u - d0 - d1) << 4));
+        }
+        return E;
+    }
+
+    // Compose two effects (the second effect must start in the spin where the first one ends)
+    CubeEffect Cube::ComposeEffects(const CubeEffect& E1, const CubeEffect& E2)
+    {
+        CubeEffect E;
+        E.Start = E1.Start;
+        E.End = E2.End;
+        E.Valid = E1.Valid && E2.Valid && E1.End == E2.Start;
+
+        for (uint p = 0u; p < 12u; p++)
+            for (uint d = 0u; d < 2u; d++) E.Edges[p][d] = E2.Edges[E1.Edges[p][d] & 0xFu][E1.Edges[p][d] >> 4];
+        for (uint p = 0u; p < 8u; p++)
+            for (uint d = 0u; d < 3u; d++) E.Corners[p][d] = E2.Corners[E1.Corners[p][d] & 0xFu][E1.Corners[p][d] >> 4];
+        return E;
+    }
+
+    // Apply an algorithm effect to the cube
+    // Returns false if the effect doesn't start in the cube spin (cube unchanged) or the effect is not valid
+    bool Cube::ApplyEffect(const CubeEffect& E)
+    {
+        if (E.Start != spin) return false;
+
+        S64 e = 0ull, c = 0ull;
+        for (uint p = 0u; p < 12u; p++)
+        {
+            const uint8_t N = E.Edges[p][(edges >> (48u + p)) & 0x1u];
+            e |= (((edges >> (4u * p)) & 0xFull) << (4u * (N & 0xFu))) | (static_cast<S64>(N >> 4) << (48u + (N & 0xFu)));
+        }
+        for (uint p = 0u; p < 8u; p++)
+        {
+            const uint8_t N = E.Corners[p][(corners >> (8u * p + 4u)) & 0x3u];
+            c |= (((corners >> (8u * p)) & 0x7ull) | (static_cast<S64>(N >> 4) << 4)) << (8u * (N & 0xFu));
+        }
+        edges = e;
+        corners = c;
+        spin = E.End;
+        return E.Valid;
+    }
+
     // Apply movement (step) to the cube
     // Returns false if the step is a close parentheses with more than one repetition
     bool Cube::ApplyStep(const Stp s)
+    {
+        const SpinStep& SS = GetSpinSteps()[static_cast<int>(spin)][static_cast<int>(s)];
+        ApplySpinStep(SS);
+        return SS.Valid;
+    }
+
+    // Physical movements for edges and corners (same order than in Stp enumeration)
+    const std::array<void (c_Edges::*)(), 18u> Cube::e_Moves = { &Cube::e_U, &Cube::e_Up, &Cube::e_U2, &Cube::e_D, &Cube::e_Dp, &Cube::e_D2,
+                                                                 &Cube::e_F, &Cube::e_Fp, &Cube::e_F2, &Cube::e_B, &Cube::e_Bp, &Cube::e_B2,
+                                                                 &Cube::e_R, &Cube::e_Rp, &Cube::e_R2, &Cube::e_L, &Cube::e_Lp, &Cube::e_L2 };
+    const std::array<void (c_Corners::*)(), 18u> Cube::c_Moves = { &Cube::c_U, &Cube::c_Up, &Cube::c_U2, &Cube::c_D, &Cube::c_Dp, &Cube::c_D2,
+                                                                   &Cube::c_F, &Cube::c_Fp, &Cube::c_F2, &Cube::c_B, &Cube::c_Bp, &Cube::c_B2,
+                                                                   &Cube::c_R, &Cube::c_Rp, &Cube::c_R2, &Cube::c_L, &Cube::c_Lp, &Cube::c_L2 };
+
+    // Get the steps for each spin (the table is built the first time, so it's ready for collections loaded at startup)
+    const Cube::SpinStepsTable& Cube::GetSpinSteps()
+    {
+        static const SpinStepsTable SpinSteps = BuildSpinSteps();
+        return SpinSteps;
+    }
+
+    // Build the steps table: the physical movements for each step in each spin are the ones with the same effect over
+    // the solved cube than the reference movements
+    Cube::SpinStepsTable Cube::BuildSpinSteps()
+    {
+        SpinStepsTable SpinSteps;
+        Cube C;
+
+        S64 EdgesMoved[18], CornersMoved[18]; // Physical movements over the solved cube
+        for (uint m = 0u; m < 18u; m++)
+        {
+            C.e_Reset();
+            C.c_Reset();
+            (C.*e_Moves[m])();
+            (C.*c_Moves[m])();
+            EdgesMoved[m] = C.edges;
+            CornersMoved[m] = C.corners;
+        }
+
+        for (uint sp = 0u; sp < 24u; sp++)
+        {
+            for (uint s = 0u; s < StepsAmount; s++)
+            {
+                SpinStep& SS = SpinSteps[sp][s];
+                C.Reset();
+                C.spin = static_cast<Spn>(sp);
+                SS.Valid = C.ApplySpinStep(static_cast<Stp>(s));
+                SS.Spin = C.spin;
+                SS.Count = 0u;
+                if (C.edges == EMASK_SOLVED && C.corners == CMASK_SOLVED) continue; // No pieces moved
+
+                for (uint m1 = 0u; m1 < 18u && SS.Count == 0u; m1++)
+                {
+                    if (C.edges == EdgesMoved[m1] && C.corners == CornersMoved[m1]) { SS.Moves[0] = static_cast<uint8_t>(m1); SS.Count = 1u; }
+                    for (uint m2 = m1 + 1u; m2 < 18u && SS.Count == 0u; m2++) // Two movements (opposite layers, so they commute)
+                    {
+                        Cube C2;
+                        (C2.*e_Moves[m1])(); (C2.*c_Moves[m1])();
+                        (C2.*e_Moves[m2])(); (C2.*c_Moves[m2])();
+                        if (C.edges == C2.edges && C.corners == C2.corners)
+                        {
+                            SS.Moves[0] = static_cast<uint8_t>(m1);
+                            SS.Moves[1] = static_cast<uint8_t>(m2);
+                            SS.Count = 2u;
+                        }
+                    }
+                }
+                assert(SS.Count > 0u && "Step moving pieces without one or two equivalent physical movements");
+            }
+        }
+        return SpinSteps;
+    }
+
+    // Apply a step through the spin dependent movements
+    // Returns false if the step is a close parentheses with more than one repetition
+    bool Cube::ApplySpinStep(const Stp s)
     {
         switch (s)
         {
@@ -2225,12 +2386,12 @@ namespace grcube3
 		LLSolve.Clear();
 		LLCase.clear();	
 		
-		Collection LL_Algorithms;
+		const Collection* LL_Algorithms;
 		
 		switch (AlgSet) // Only orientation algorithm collections
 		{
-			case AlgSets::OLL: LL_Algorithms = OLL_Algorithms; break;
-			case AlgSets::OCLL: LL_Algorithms = OCLL_Algorithms; break;
+			case AlgSets::OLL: LL_Algorithms = &GetAlgorithms(AlgSets::OLL); break;
+			case AlgSets::OCLL: LL_Algorithms = &GetAlgorithms(AlgSets::OCLL); break;
 			default: return false;
 		}
 		
@@ -2239,56 +2400,77 @@ namespace grcube3
 				  DownLayer = Cube::GetDownSliceLayer(CubeBase.GetSpin());
 
 		bool LL_Found = false;
-        Spn Spin1, Spin2; // Cube spins before and after applying algorithm
-        Stp StepS1, StepS2; // Steps to return cube to the start spin
+		uint LL_Index = 0u;
+		Stp yLL = Stp::NONE; // y turn before algorithm
+
+		// The recognition index (first two layers and up face orientation) gives the first indexed case and y turn that
+		// orientate the cube, the cases out of the index are checked one by one
+		const LLIndex* LL_RecIndex = LLIndex::Get(*LL_Algorithms, CubeBase.GetSpin(), LLIndex::Type::ORIENTATION);
+		const LLIndex::Entry* LL_Entry = LL_RecIndex->Find(CubeBase);
+		if (LL_Entry != nullptr)
+		{
+			LL_Found = true;
+			LL_Index = LL_Entry->Case;
+			yLL = Algorithm::yTurns[LL_Entry->Before];
+		}
 
-        for (uint LL_Index = 0u; LL_Index < LL_Algorithms.GetCasesNumber(); LL_Index++)
+        for (LL_Index = LL_Found ? LL_Index : LL_RecIndex->GetIndexedCases(); !LL_Found && LL_Index < LL_Algorithms->GetCasesNumber(); LL_Index++)
         {
-            for (const auto yLL: Algorithm::yTurns) // y turn before algorithm
+            for (const auto y: Algorithm::yTurns) // y turn before algorithm
             {
 				Cube CubeLL = CubeBase;
-				CubeLL.ApplyStep(yLL);
-				Spin1 = CubeLL.GetSpin();
-				CubeLL.ApplyAlgorithm(LL_Algorithms[LL_Index]);
-				Spin2 = CubeLL.GetSpin();
+				CubeLL.ApplyStep(y);
+				const Spn Spin1 = CubeLL.GetSpin();
+				CubeLL.ApplyEffect(LL_Algorithms->GetEffect(LL_Index, Spin1)); // Precomputed algorithm effect
+				const Spn Spin2 = CubeLL.GetSpin();
 				if (Spin1 != Spin2)
 				{
+					Stp StepS1, StepS2;
 					Cube::GetSpinsSteps(Spin2, Spin1, StepS1, StepS2);
 					if (StepS1 != Stp::NONE) CubeLL.ApplyStep(StepS1);
 					if (StepS2 != Stp::NONE) CubeLL.ApplyStep(StepS2);
 				}
-				else StepS1 = StepS2 = Stp::NONE;
 
 				LL_Found = CubeLL.IsSolved(DownLayer) && CubeLL.IsSolved(MidLayer) && CubeLL.IsFaceOriented(UpLayer);
 
 				if (LL_Found)
 				{
-					LLCase = LL_Algorithms.GetCaseName(LL_Index);
-
-					if (yLL != Stp::NONE)
-					{
-						// LLSolve.Append(Stp::PARENTHESIS_OPEN);
-						LLSolve.Append(yLL);
-						// LLSolve.Append(Stp::PARENTHESIS_CLOSE_1_REP);
-					}
-					LLSolve.Append(LL_Algorithms[LL_Index]);
-					
-					// If the algorithm changes cube orientation, add a turn to recover up layer
-					if (Cube::GetUpSliceLayer(Spin1) != Cube::GetUpSliceLayer(Spin2))
-					{
-						// LLSolve.Append(Stp::PARENTHESIS_OPEN);
-						LLSolve.Append(StepS1);
-						if (StepS2 != Stp::NONE) LLSolve.Append(StepS2);
-						// LLSolve.Append(Stp::PARENTHESIS_CLOSE_1_REP);
-					}
-
+					yLL = y;
 					break;
 				}
             }
             if (LL_Found) break; // Release for loop
         }
 
-        return LL_Found;
+		if (!LL_Found) return false;
+
+        Cube CubeLL = CubeBase;
+        CubeLL.ApplyStep(yLL);
+        const Spn Spin1 = CubeLL.GetSpin(), // Cube spins before and after applying algorithm
+                  Spin2 = LL_Algorithms->GetEffect(LL_Index, Spin1).End;
+        Stp StepS1 = Stp::NONE, StepS2 = Stp::NONE; // Steps to return cube to the start spin
+        if (Spin1 != Spin2) Cube::GetSpinsSteps(Spin2, Spin1, StepS1, StepS2);
+
+		LLCase = LL_Algorithms->GetCaseName(LL_Index);
+
+		if (yLL != Stp::NONE)
+		{
+			// LLSolve.Append(Stp::PARENTHESIS_OPEN);
+			LLSolve.Append(yLL);
+			// LLSolve.Append(Stp::PARENTHESIS_CLOSE_1_REP);
+		}
+		LLSolve.Append((*LL_Algorithms)[LL_Index]);
+					
+		// If the algorithm changes cube orientation, add a turn to recover up layer
+		if (Cube::GetUpSliceLayer(Spin1) != Cube::GetUpSliceLayer(Spin2))
+		{
+			// LLSolve.Append(Stp::PARENTHESIS_OPEN);
+			LLSolve.Append(StepS1);
+			if (StepS2 != Stp::NONE) LLSolve.Append(StepS2);
+			// LLSolve.Append(Stp::PARENTHESIS_CLOSE_1_REP);
+		}
+
+        return true;
 	}
 	
 	// Algorithm search from a collection
@@ -2298,71 +2480,54 @@ namespace grcube3
 		LLCase.clear();	
 		AUFStep = Stp::NONE;
 		
-		Collection LL_Algorithms;
+		const Collection* LL_Algorithms;
 		
 		switch (AlgSet)
 		{
-			case AlgSets::_1LLL: LL_Algorithms = Algorithms_1LLL; break;
-			case AlgSets::PLL: LL_Algorithms = PLL_Algorithms; break;
-			case AlgSets::ZBLL: LL_Algorithms = ZBLL_Algorithms; break;
-			case AlgSets::EPLL: LL_Algorithms = EPLL_Algorithms; break;
+			case AlgSets::_1LLL: LL_Algorithms = &GetAlgorithms(AlgSets::_1LLL); break;
+			case AlgSets::PLL: LL_Algorithms = &GetAlgorithms(AlgSets::PLL); break;
+			case AlgSets::ZBLL: LL_Algorithms = &GetAlgorithms(AlgSets::ZBLL); break;
+			case AlgSets::EPLL: LL_Algorithms = &GetAlgorithms(AlgSets::EPLL); break;
 			default: return false; 
 		}
 
-		bool LL_Found = false;
-        Spn Spin1, Spin2; // Cube spins before and after applying algorithm
-        Stp StepS1, StepS2; // Steps to return cube to the start spin
+		// The recognition index gives the first case, y turn and AUF that solve the cube (in cases, y turns and AUF order)
+		// Only the lookup is timed for the recognition statistics (the index is built the first time it is used)
+		const LLIndex* LL_RecIndex = LLIndex::Get(*LL_Algorithms, CubeBase.GetSpin());
+		const auto time_lookup_start = std::chrono::steady_clock::now();
+		const LLIndex::Entry* LL_Entry = LL_RecIndex->Find(CubeBase);
+		LLIndex::AddLookup(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - time_lookup_start).count());
+		if (LL_Entry == nullptr) return false;
 
-        for (uint LL_Index = 0u; LL_Index < LL_Algorithms.GetCasesNumber(); LL_Index++)
-        {
-            for (const auto yLL: Algorithm::yTurns) // y turn before algorithm
-            {
-                for (const auto ULL: Algorithm::UMovs) // U movement after algorithm (AUF)
-                {
-                    Cube CubeLL = CubeBase;
-                    CubeLL.ApplyStep(yLL);
-                    Spin1 = CubeLL.GetSpin();
-                    CubeLL.ApplyAlgorithm(LL_Algorithms[LL_Index]);
-                    Spin2 = CubeLL.GetSpin();
-                    if (Spin1 != Spin2)
-                    {
-                        Cube::GetSpinsSteps(Spin2, Spin1, StepS1, StepS2);
-                        if (StepS1 != Stp::NONE) CubeLL.ApplyStep(StepS1);
-                        if (StepS2 != Stp::NONE) CubeLL.ApplyStep(StepS2);
-                    }
-                    else StepS1 = StepS2 = Stp::NONE;
-                    CubeLL.ApplyStep(ULL);
+		const uint LL_Index = LL_Entry->Case;
+		const Stp yLL = Algorithm::yTurns[LL_Entry->Before];
 
-					LL_Found = CubeLL.IsSolved();
+        Cube CubeLL = CubeBase;
+        CubeLL.ApplyStep(yLL);
+        const Spn Spin1 = CubeLL.GetSpin(), // Cube spins before and after applying algorithm
+                  Spin2 = LL_Algorithms->GetEffect(LL_Index, Spin1).End;
+        Stp StepS1 = Stp::NONE, StepS2 = Stp::NONE; // Steps to return cube to the start spin
+        if (Spin1 != Spin2) Cube::GetSpinsSteps(Spin2, Spin1, StepS1, StepS2);
 
-                    if (LL_Found)
-                    {
-                        LLCase = LL_Algorithms.GetCaseName(LL_Index);
+        LLCase = LL_Algorithms->GetCaseName(LL_Index);
 
-                        if (yLL != Stp::NONE)
-                        {
-                            // LLSolve.Append(Stp::PARENTHESIS_OPEN);
-                            LLSolve.Append(yLL);
-                            // LLSolve.Append(Stp::PARENTHESIS_CLOSE_1_REP);
-                        }
-                        LLSolve.Append(LL_Algorithms[LL_Index]);
-						if (Cube::GetUpSliceLayer(Spin1) != Cube::GetUpSliceLayer(Spin2))
-						{
-							// LLSolve.Append(Stp::PARENTHESIS_OPEN);
-							LLSolve.Append(StepS1);
-							if (StepS2 != Stp::NONE) LLSolve.Append(StepS2);
-							// LLSolve.Append(Stp::PARENTHESIS_CLOSE_1_REP);
-						}
-                        AUFStep = ULL;
-                        break;
-                    }
-                }
-                if (LL_Found) break; // Release for loop
-            }
-            if (LL_Found) break; // Release for loop
+        if (yLL != Stp::NONE)
+        {
+            // LLSolve.Append(Stp::PARENTHESIS_OPEN);
+            LLSolve.Append(yLL);
+            // LLSolve.Append(Stp::PARENTHESIS_CLOSE_1_REP);
         }
+        LLSolve.Append((*LL_Algorithms)[LL_Index]);
+		if (Cube::GetUpSliceLayer(Spin1) != Cube::GetUpSliceLayer(Spin2))
+		{
+			// LLSolve.Append(Stp::PARENTHESIS_OPEN);
+			LLSolve.Append(StepS1);
+			if (StepS2 != Stp::NONE) LLSolve.Append(StepS2);
+			// LLSolve.Append(Stp::PARENTHESIS_CLOSE_1_REP);
+		}
+        AUFStep = Algorithm::UMovs[LL_Entry->After];
 
-        return LL_Found;
+        return true;
 	}
 	
 	// Algorithm search from a collection (CMLL or COLL)
@@ -2372,12 +2537,12 @@ namespace grcube3
 		LLCase.clear();
         AUFStep = Stp::NONE;
 		
-		Collection LL_Algorithms;
+		const Collection* LL_Algorithms;
 		
 		switch (AlgSet) // Only corners algorithm collections
 		{
-			case AlgSets::CMLL: LL_Algorithms = CMLL_Algorithms; break;
-			case AlgSets::COLL: LL_Algorithms = COLL_Algorithms; break;
+			case AlgSets::CMLL: LL_Algorithms = &GetAlgorithms(AlgSets::CMLL); break;
+			case AlgSets::COLL: LL_Algorithms = &GetAlgorithms(AlgSets::COLL); break;
 			default: return false; 
 		}
 		
@@ -2397,27 +2562,41 @@ namespace grcube3
 		}
 
 		bool LL_Found = false;
-        Spn Spin1, Spin2; // Cube spins before and after applying algorithm
-        Stp StepS1, StepS2; // Steps to return cube to the start spin
+		uint LL_Index = 0u;
+		Stp ULL = Stp::NONE; // U movement before algorithm
+
+		// The recognition index (corners, middle layer and DR/DL edges) gives the first indexed case, U movement and AUF
+		// that solve the corners, the cases out of the index are checked one by one
+		const LLIndex* LL_RecIndex = LLIndex::Get(*LL_Algorithms, CubeBase.GetSpin(), LLIndex::Type::CORNERS);
+		const LLIndex::Entry* LL_Entry = LL_RecIndex->Find(CubeBase);
+		if (LL_Entry != nullptr)
+		{
+			LL_Found = true;
+			LL_Index = LL_Entry->Case;
+			ULL = Algorithm::UMovs[LL_Entry->Before];
+			AUFStep = Algorithm::UMovs[LL_Entry->After];
+		}
 
-        for (uint LL_Index = 0u; LL_Index < LL_Algorithms.GetCasesNumber(); LL_Index++)
+        for (LL_Index = LL_Found ? LL_Index : LL_RecIndex->GetIndexedCases(); !LL_Found && LL_Index < LL_Algorithms->GetCasesNumber(); LL_Index++)
         {
             for (const auto ULL1: Algorithm::UMovs) // U movement before algorithm
             {
+                Cube CubeAlg = CubeBase; // Cube after the algorithm (before the AUF)
+                CubeAlg.ApplyStep(ULL1);
+                const Spn Spin1 = CubeAlg.GetSpin();
+                CubeAlg.ApplyEffect(LL_Algorithms->GetEffect(LL_Index, Spin1)); // Precomputed algorithm effect
+                const Spn Spin2 = CubeAlg.GetSpin();
+                if (Spin1 != Spin2)
+                {
+                    Stp StepS1, StepS2;
+                    Cube::GetSpinsSteps(Spin2, Spin1, StepS1, StepS2);
+                    if (StepS1 != Stp::NONE) CubeAlg.ApplyStep(StepS1);
+                    if (StepS2 != Stp::NONE) CubeAlg.ApplyStep(StepS2);
+                }
+
                 for (const auto ULL2: Algorithm::UMovs) // U movement after algorithm (AUF)
                 {
-                    Cube CubeLL = CubeBase;
-                    CubeLL.ApplyStep(ULL1);
-                    Spin1 = CubeLL.GetSpin();
-                    CubeLL.ApplyAlgorithm(LL_Algorithms[LL_Index]);
-                    Spin2 = CubeLL.GetSpin();
-                    if (Spin1 != Spin2)
-                    {
-                        Cube::GetSpinsSteps(Spin2, Spin1, StepS1, StepS2);
-                        if (StepS1 != Stp::NONE) CubeLL.ApplyStep(StepS1);
-                        if (StepS2 != Stp::NONE) CubeLL.ApplyStep(StepS2);
-                    }
-                    else StepS1 = StepS2 = Stp::NONE;
+                    Cube CubeLL = CubeAlg;
                     CubeLL.ApplyStep(ULL2);
 
 					LL_Found = CubeLL.IsSolved(DownLayerCorners) && CubeLL.IsSolved(MidLayer) && CubeLL.IsSolved(UpLayerCorners) &&
@@ -2425,22 +2604,7 @@ namespace grcube3
 
                     if (LL_Found)
                     {
-                        LLCase = LL_Algorithms.GetCaseName(LL_Index);
-
-                        if (ULL1 != Stp::NONE)
-                        {
-                            // LLSolve.Append(Stp::PARENTHESIS_OPEN);
-                            LLSolve.Append(ULL1);
-                            // LLSolve.Append(Stp::PARENTHESIS_CLOSE_1_REP);
-                        }
-                        LLSolve.Append(LL_Algorithms[LL_Index]);
-						if (Cube::GetUpSliceLayer(Spin1) != Cube::GetUpSliceLayer(Spin2))
-						{
-							// LLSolve.Append(Stp::PARENTHESIS_OPEN);
-							LLSolve.Append(StepS1);
-							if (StepS2 != Stp::NONE) LLSolve.Append(StepS2);
-							// LLSolve.Append(Stp::PARENTHESIS_CLOSE_1_REP);
-						}
+                        ULL = ULL1;
                         AUFStep = ULL2;
                         break;
                     }
@@ -2450,7 +2614,33 @@ namespace grcube3
             if (LL_Found) break; // Release for loop
         }
 
-        return LL_Found;
+		if (!LL_Found) return false;
+
+        Cube CubeAlg = CubeBase;
+        CubeAlg.ApplyStep(ULL);
+        const Spn Spin1 = CubeAlg.GetSpin(), // Cube spins before and after applying algorithm
+                  Spin2 = LL_Algorithms->GetEffect(LL_Index, Spin1).End;
+        Stp StepS1 = Stp::NONE, StepS2 = Stp::NONE; // Steps to return cube to the start spin
+        if (Spin1 != Spin2) Cube::GetSpinsSteps(Spin2, Spin1, StepS1, StepS2);
+
+        LLCase = LL_Algorithms->GetCaseName(LL_Index);
+
+        if (ULL != Stp::NONE)
+        {
+            // LLSolve.Append(Stp::PARENTHESIS_OPEN);
+            LLSolve.Append(ULL);
+            // LLSolve.Append(Stp::PARENTHESIS_CLOSE_1_REP);
+        }
+        LLSolve.Append((*LL_Algorithms)[LL_Index]);
+		if (Cube::GetUpSliceLayer(Spin1) != Cube::GetUpSliceLayer(Spin2))
+		{
+			// LLSolve.Append(Stp::PARENTHESIS_OPEN);
+			LLSolve.Append(StepS1);
+			if (StepS2 != Stp::NONE) LLSolve.Append(StepS2);
+			// LLSolve.Append(Stp::PARENTHESIS_CLOSE_1_REP);
+		}
+
+        return true;
 	}
 
     // Get given pieces report for current cube
@@ -27,6 +27,7 @@
 #include "corners.h"
 #include "algorithm.h"
 #include "collection.h"
+#include "lazy_file.h"
 
 namespace grcube3
 {
@@ -63,6 +64,30 @@ namespace grcube3
         // If there are parentheses with more than one repetition returns false and cube status remains unchanged
 		bool ApplyAlgorithm(const Algorithm&);
 
+		// Spin collapsed step: physical movements (edges + corners, 0 to 17 in the Stp single layer movements order)
+		// and spin after the step, for a step in a given spin
+		struct SpinStep
+		{
+			uint8_t Moves[2], Count; // Physical movements (a middle layer movement needs two)
+			Spn Spin; // Spin after the step
+			bool Valid; // False for close parentheses with more than one repetition
+		};
+
+		static constexpr uint StepsAmount = static_cast<uint>(Stp::PARENTHESIS_CLOSE_9_REP) + 1u;
+		using SpinStepsTable = std::array<std::array<SpinStep, StepsAmount>, 24u>;
+
+		static const SpinStepsTable& GetSpinSteps(); // Steps for each spin (the table is built the first time)
+
+		// Get the pieces effect of an algorithm applied from the given spin
+		static CubeEffect GetEffect(const Algorithm&, const Spn);
+
+		// Compose two effects (the second effect must start in the spin where the first one ends)
+		static CubeEffect ComposeEffects(const CubeEffect&, const CubeEffect&);
+
+		// Apply an algorithm effect to the cube (the same result than applying the algorithm, in a single pass)
+		// Returns false if the effect doesn't start in the cube spin (cube unchanged) or the effect is not valid
+		bool ApplyEffect(const CubeEffect&);
+
 		// Equal operator -> corners & edges must match, spin is not important
 		bool operator==(Cube& rhcube) const { return edges == rhcube.GetEdgesStatus() && corners == rhcube.GetCornersStatus(); }
 
@@ -87,6 +112,9 @@ namespace grcube3
 		// Get edges direction status
         S64 GetEdgesDirStatus() const { return edges & EMASK_DIR_DATA; }
 
+        // Set edges and corners status (not checked, must be a valid status)
+        void SetStatus(const S64 e, const S64 c) { edges = e; corners = c; }
+
         // Get cube spin
         Spn GetSpin() const { return spin; }
 
@@ -345,30 +373,27 @@ namespace grcube3
 		static bool CornersLL(Algorithm&, std::string&, Stp&, const AlgSets, const Cube&);
 
         // Get number of collections cases
-        static uint GetOLLCases() { return OLL_Algorithms.GetCasesNumber(); }
-        static uint GetPLLCases() { return PLL_Algorithms.GetCasesNumber(); }
-        static uint Get1LLLCases() { return Algorithms_1LLL.GetCasesNumber(); }
-        static uint GetZBLLCases() { return ZBLL_Algorithms.GetCasesNumber(); }
-        static uint GetOCLLCases() { return OCLL_Algorithms.GetCasesNumber(); }
-        static uint GetCMLLCases() { return CMLL_Algorithms.GetCasesNumber(); }
-        static uint GetCOLLCases() { return COLL_Algorithms.GetCasesNumber(); }
-        static uint GetEPLLCases() { return EPLL_Algorithms.GetCasesNumber(); }
+        static uint GetOLLCases() { return GetAlgorithms(AlgSets::OLL).GetCasesNumber(); }
+        static uint GetPLLCases() { return GetAlgorithms(AlgSets::PLL).GetCasesNumber(); }
+        static uint Get1LLLCases() { return GetAlgorithms(AlgSets::_1LLL).GetCasesNumber(); }
+        static uint GetZBLLCases() { return GetAlgorithms(AlgSets::ZBLL).GetCasesNumber(); }
+        static uint GetOCLLCases() { return GetAlgorithms(AlgSets::OCLL).GetCasesNumber(); }
+        static uint GetCMLLCases() { return GetAlgorithms(AlgSets::CMLL).GetCasesNumber(); }
+        static uint GetCOLLCases() { return GetAlgorithms(AlgSets::COLL).GetCasesNumber(); }
+        static uint GetEPLLCases() { return GetAlgorithms(AlgSets::EPLL).GetCasesNumber(); }
+
+        // Collection with solve algorithms (by case) for the given algset, loaded the first time it is required
+        static const Collection& GetAlgorithms(const AlgSets AS) { return AlgSetsCollections[static_cast<int>(AS)].Get(); }
+        static bool IsLoaded(const AlgSets AS) { return AlgSetsCollections[static_cast<int>(AS)].IsLoaded(); }
+        static std::string GetAlgorithmsFile(const AlgSets AS) { return AlgSetsCollections[static_cast<int>(AS)].GetFilename(); }
 
         const static std::array<Lyr, 6u> ExtLayers; // Array of external layers
-
-        // Static collections with solve algorithms (by case)
-        const static Collection OLL_Algorithms,
-                                PLL_Algorithms,
-                                Algorithms_1LLL,
-                                ZBLL_Algorithms,
-                                OCLL_Algorithms,
-                                CMLL_Algorithms,
-                                COLL_Algorithms,
-                                EPLL_Algorithms;
 		
 	private:
 		
 		Spn spin; // Cube spin
+
+        const static LazyFile<Collection> AlgSetsCollections[8]; // Algorithms collections (in AlgSets order)
 		
 		// Cube x turn
         void x()  { spin = spn_Turns_x[static_cast<int>(spin)]; }
@@ -404,6 +429,26 @@ namespace grcube3
         void R(); void R2(); void Rp(); // Cube R slice movements
         void L(); void L2(); void Lp(); // Cube L slice movements
 
+        // Apply a step through the spin dependent movements (reference movements used to build the spin steps table)
+        bool ApplySpinStep(const Stp);
+
+        static SpinStepsTable BuildSpinSteps(); // Build the steps table from the reference movements
+
+        // Apply a spin collapsed step (no spin switch)
+        void ApplySpinStep(const SpinStep& SS)
+        {
+            for (uint n = 0u; n < SS.Count; n++)
+            {
+                (this->*e_Moves[SS.Moves[n]])();
+                (this->*c_Moves[SS.Moves[n]])();
+            }
+            spin = SS.Spin;
+        }
+
+        // Physical movements for edges and corners
+        const static std::array<void (c_Edges::*)(), 18u> e_Moves;
+        const static std::array<void (c_Corners::*)(), 18u> c_Moves;
+
 		// Arrays to follow spins when a cube has a turn
         const static Spn spn_Turns_x[24];
         const static Spn spn_Turns_x2[24];
@@ -0,0 +1,53 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#include "cube_batch.h"
+
+namespace grcube3
+{
+	// Set the given number of cubes (up to MaxSize) with the cube state
+	void CubeBatch::Set(const Cube& C, const uint n)
+	{
+		Size = n < MaxSize ? n : MaxSize;
+		if (Size == 0u) return;
+		Cubes[0].Set(C);
+		for (uint i = 1u; i < Size; i++) Cubes[i] = Cubes[0];
+	}
+
+	// Apply consecutive algorithms to the cubes (algorithm First + n to cube n)
+	uint CubeBatch::ApplyAlgorithms(const std::vector<Algorithm>& Algs, const uint First)
+	{
+		uint Valid = 0u;
+		for (uint n = 0u; n < Size && First + n < Algs.size(); n++)
+			if (Cubes[n].ApplyAlgorithm(Algs[First + n])) Valid |= 1u << n;
+		return Valid;
+	}
+
+	// Bitmap of cubes with the pieces in the lanes mask solved
+	uint CubeBatch::IsSolved(const LanesMask& M) const
+	{
+		uint Solved = 0u;
+		for (uint n = 0u; n < Size; n++) if (Cubes[n].IsSolved(M)) Solved |= 1u << n;
+		return Solved;
+	}
+}
@@ -0,0 +1,73 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#pragma once
+
+#include <vector>
+
+#include "cube_lanes.h"
+
+namespace grcube3
+{
+	// Batch of cubes in byte lanes (one SIMD register per cube) to evaluate many algorithms over the same base cube
+	// Steps can be applied to all the cubes or to a single cube, and the solved checks return a bitmap with a bit for
+	// each cube in the batch (bit n for cube n)
+	class CubeBatch
+	{
+	public:
+		static constexpr uint MaxSize = 32u; // Maximum number of cubes in the batch (bits in the bitmaps)
+
+		CubeBatch() { Size = 0u; }
+
+		void Set(const Cube&, const uint); // Set the given number of cubes (up to MaxSize) with the cube state
+		uint GetSize() const { return Size; } // Number of cubes in the batch
+
+		void ApplyStep(const Stp S) { for (uint n = 0u; n < Size; n++) Cubes[n].ApplyStep(S); } // Apply a step to all cubes
+		bool ApplyStep(const uint n, const Stp S) { return Cubes[n].ApplyStep(S); } // Apply a step to the given cube
+
+		// Apply consecutive algorithms to the cubes (algorithm First + n to cube n), returns the bitmap of cubes with
+		// valid algorithms (no parentheses with more than one repetition)
+		uint ApplyAlgorithms(const std::vector<Algorithm>&, const uint);
+
+		// Set the cubes with the base cube and the consecutive algorithms from the given one (up to MaxSize algorithms)
+		uint SetAlgorithms(const Cube& C, const std::vector<Algorithm>& Algs, const uint First)
+		{
+			Set(C, First < Algs.size() ? static_cast<uint>(Algs.size()) - First : 0u);
+			return ApplyAlgorithms(Algs, First);
+		}
+
+		// Set the given cube with the base cube and the algorithm applied with a cube (for the algorithms not valid in byte
+		// lanes, as the parentheses with repetitions)
+		void SetAlgorithm(const uint n, const Cube& C, const Algorithm& A) { Cube CA = C; CA.ApplyAlgorithm(A); Cubes[n].Set(CA); }
+
+		uint IsSolved(const LanesMask&) const; // Bitmap of cubes with the pieces in the lanes mask solved
+		uint IsSolved(const Pgr G) const { return IsSolved(LanesMask(G)); } // Bitmap of cubes with the pieces group solved
+
+		Cube GetCube(const uint n) const { return Cubes[n].GetCube(); } // Get a cube of the batch
+		const CubeLanes& GetLanes(const uint n) const { return Cubes[n]; } // Get a cube of the batch in byte lanes
+
+	private:
+		CubeLanes Cubes[MaxSize]; // Cubes in the batch
+		uint Size; // Number of cubes in the batch
+	};
+}
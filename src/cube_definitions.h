@@ -285,7 +285,7 @@ namespace grcube3
 		NONE, U, D, F, B, R, L, E, S, M
 	};
 	
-	enum class Stp // All possible movements
+	enum class Stp : std::uint8_t // All possible movements (coded in a byte, see StepBuffer)
 	{ 
 		NONE, // No movement
 	
@@ -442,4 +442,14 @@ namespace grcube3
     {
         Movements, HTM, QTM, STM, QSTM, ETM, ATM, PTM, HTM15, OBTM
     };
+
+	// Pieces effect of an algorithm applied from a given spin (a cube state permutation and orientation change)
+	// For each edge position and direction, and for each corner position and direction, the new position and
+	// direction of the piece (new position + new direction * 16, as a byte in the corners status)
+	struct CubeEffect
+	{
+		std::uint8_t Edges[12][2], Corners[8][3];
+		Spn Start, End; // Spin before and after the effect
+		bool Valid; // False if the algorithm has parentheses with more than one repetition
+	};
 }
@@ -0,0 +1,199 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#include "cube_lanes.h"
+
+namespace grcube3
+{
+	S64 CubeLanes::EdgesSolved, CubeLanes::CornersSolved;
+	alignas(32) uint8_t CubeLanes::Perms[18][32];
+	alignas(32) uint8_t CubeLanes::Maps[18][32];
+	alignas(32) const uint8_t CubeLanes::DirMaps[32] = { 0x00u, 0x10u, 0x20u, 0x00u, 0x10u, 0x00u, 0x20u, 0x00u, // Same, swap 0-1
+														 0x00u, 0x20u, 0x10u, 0x00u, 0x20u, 0x10u, 0x00u, 0x00u, // Swap 1-2, swap 0-2
+														 0x00u, 0x10u, 0x20u, 0x00u, 0x10u, 0x00u, 0x20u, 0x00u, // Same table for the corners half
+														 0x00u, 0x20u, 0x10u, 0x00u, 0x20u, 0x10u, 0x00u, 0x00u };
+	const Cube::SpinStepsTable* CubeLanes::SpinSteps = nullptr;
+	std::once_flag CubeLanes::TablesFlag;
+
+	// Auxiliary cube to set any pieces status
+	class LanesCube : public Cube
+	{
+	public:
+		void SetStatus(const S64 e, const S64 c, const Spn s)
+		{
+			edges = e;
+			corners = c;
+			SetSpin(s); // Rotations don't change the pieces
+		}
+	};
+
+	// Movements tables initialization from the cube movements
+	void CubeLanes::InitTables()
+	{
+		LanesCube C;
+		EdgesSolved = C.GetEdgesStatus();
+		CornersSolved = C.GetCornersStatus();
+
+		// Physical movements are the single layer movements with the default spin (as in the cube spin steps): in the
+		// solved cube each piece comes from the lane with his own index
+		S64 EdgesMoved[18], CornersMoved[18];
+		for (uint m = 0u; m < 18u; m++)
+		{
+			C.Reset();
+			C.ApplyStep(static_cast<Stp>(m + 1u));
+			EdgesMoved[m] = C.GetEdgesStatus();
+			CornersMoved[m] = C.GetCornersStatus();
+
+			for (uint n = 0u; n < 32u; n++) { Perms[m][n] = static_cast<uint8_t>(n & 0xFu); Maps[m][n] = 0u; }
+			for (uint p = 0u; p < 12u; p++) Perms[m][p] = static_cast<uint8_t>((EdgesMoved[m] >> (4u * p)) & 0xFu);
+			for (uint p = 0u; p < 8u; p++) Perms[m][16u + p] = static_cast<uint8_t>((CornersMoved[m] >> (8u * p)) & 0x7u);
+
+			// Directions map in each lane: the one that gives the new direction for all the directions
+			uint8_t NewDirs[3][32];
+			for (uint d = 0u; d < 3u; d++)
+			{
+				S64 E = EdgesSolved, Cr = CornersSolved;
+				if (d == 1u) E |= 0xFFFull << 48;
+				for (uint p = 0u; p < 8u; p++) Cr |= static_cast<S64>(d) << (8u * p + 4u);
+				C.SetStatus(E, Cr, Spn::Default);
+				C.ApplyStep(static_cast<Stp>(m + 1u));
+				for (uint p = 0u; p < 12u; p++) NewDirs[d][p] = static_cast<uint8_t>(((C.GetEdgesStatus() >> (48u + p)) & 0x1u) << 4);
+				for (uint p = 0u; p < 8u; p++) NewDirs[d][16u + p] = static_cast<uint8_t>((C.GetCornersStatus() >> (8u * p)) & 0x30u);
+			}
+			for (uint n = 0u; n < 32u; n++)
+			{
+				if ((n & 0xFu) >= (n < 16u ? 12u : 8u)) continue; // Unused lane
+				const uint NDirs = n < 16u ? 2u : 3u;
+				for (uint i = 0u; i < 4u; i++)
+				{
+					bool Match = true;
+					for (uint d = 0u; d < NDirs; d++) Match = Match && DirMaps[4u * i + d] == NewDirs[d][n];
+					if (Match) { Maps[m][n] = static_cast<uint8_t>(4u * i); break; }
+				}
+			}
+		}
+
+		SpinSteps = &Cube::GetSpinSteps();
+	}
+
+	// Solved state with default spin
+	void CubeLanes::Reset()
+	{
+		Set(Cube());
+	}
+
+	// Copy the cube state
+	void CubeLanes::Set(const Cube& C)
+	{
+		const S64 E = C.GetEdgesStatus(), Cr = C.GetCornersStatus();
+		for (uint n = 0u; n < 32u; n++) Lanes[n] = 0u;
+		for (uint p = 0u; p < 12u; p++) Lanes[p] = static_cast<uint8_t>(((E >> (4u * p)) & 0xFu) | (((E >> (48u + p)) & 0x1u) << 4));
+		for (uint p = 0u; p < 8u; p++) Lanes[16u + p] = static_cast<uint8_t>((Cr >> (8u * p)) & 0xFFu);
+		Spin = C.GetSpin();
+	}
+
+	// Apply an algorithm (it should not have parentheses with more than one repetition)
+	bool CubeLanes::ApplyAlgorithm(const Algorithm& A)
+	{
+		for (uint n = 0u; n < A.GetSize(); n++) if (!ApplyStep(A.At(n))) return false;
+		return true;
+	}
+
+	// Get the state as a cube
+	Cube CubeLanes::GetCube() const
+	{
+		LanesCube C;
+		C.SetStatus(GetEdgesStatus(), GetCornersStatus(), Spin);
+		return C;
+	}
+
+	// Lanes mask from the cube edges and corners masks
+	LanesMask::LanesMask(const S64 EMask, const S64 CMask)
+	{
+		std::call_once(CubeLanes::TablesFlag, CubeLanes::InitTables);
+
+		for (uint n = 0u; n < 32u; n++) Mask[n] = Solved[n] = 0u;
+		for (uint p = 0u; p < 12u; p++)
+		{
+			Mask[p] = static_cast<uint8_t>(((EMask >> (4u * p)) & 0xFu) | (((EMask >> (48u + p)) & 0x1u) << 4));
+			Solved[p] = static_cast<uint8_t>((((CubeLanes::EdgesSolved >> (4u * p)) & 0xFu) | (((CubeLanes::EdgesSolved >> (48u + p)) & 0x1u) << 4)) & Mask[p]);
+		}
+		for (uint p = 0u; p < 8u; p++)
+		{
+			Mask[16u + p] = static_cast<uint8_t>((CMask >> (8u * p)) & 0xFFu);
+			Solved[16u + p] = static_cast<uint8_t>((CubeLanes::CornersSolved >> (8u * p)) & Mask[16u + p]);
+		}
+	}
+
+	// Lanes mask for a pieces group (as in Cube::IsSolved)
+	LanesMask::LanesMask(const Pgr G)
+	{
+		std::vector<Pcp> PList;
+		Cube::AddToPositionsList(G, PList);
+		*this = LanesMask(PList);
+	}
+
+	// Lanes mask for a pieces positions list
+	LanesMask::LanesMask(const std::vector<Pcp>& PList)
+	{
+		std::vector<Edp> EList;
+		std::vector<Cnp> CList;
+
+		for (const auto P : PList)
+		{
+			if (Cube::IsEdge(P)) EList.push_back(Cube::PcpToEdp(P));
+			else if (Cube::IsCorner(P)) CList.push_back(Cube::PcpToCnp(P));
+		}
+
+		*this = LanesMask(Cube::GetMaskSolvedEdges(EList), Cube::GetMaskSolvedCorners(CList));
+	}
+
+	// Get the edges status (as in the cube)
+	S64 CubeLanes::GetEdgesStatus() const
+	{
+		S64 E = 0ull;
+		for (uint p = 0u; p < 12u; p++)
+			E |= (static_cast<S64>(Lanes[p] & 0xFu) << (4u * p)) | (static_cast<S64>(Lanes[p] >> 4) << (48u + p));
+		return E;
+	}
+
+	// Get the corners status (as in the cube)
+	S64 CubeLanes::GetCornersStatus() const
+	{
+		S64 Cr = 0ull;
+		for (uint p = 0u; p < 8u; p++) Cr |= static_cast<S64>(Lanes[16u + p]) << (8u * p);
+		return Cr;
+	}
+
+	// Name of the movements code used
+	const char* CubeLanes::GetKernel()
+	{
+#if defined(__AVX2__)
+		return "AVX2";
+#elif defined(__SSSE3__)
+		return "SSSE3";
+#else
+		return "scalar";
+#endif
+	}
+}
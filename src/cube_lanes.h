@@ -0,0 +1,158 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#pragma once
+
+#include <mutex>
+
+#include "cube.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace grcube3
+{
+	// Pieces mask in byte lanes (from the cube edges and corners masks) to check solved pieces
+	struct LanesMask
+	{
+		alignas(32) uint8_t Mask[32], Solved[32]; // Bits to check in each lane and their values with the pieces solved
+
+		LanesMask(const S64, const S64); // Mask from the cube edges and corners masks
+		explicit LanesMask(const Pgr); // Mask for a pieces group
+		explicit LanesMask(const std::vector<Pcp>&); // Mask for a pieces positions list
+	};
+
+	// Cube state as byte lanes (alternative to the packed edges and corners status for fast movements)
+	// A byte for each edge position (edge + direction * 16) and a byte for each corner position (corner + direction * 16,
+	// the same byte than in the corners status). Each single layer movement is a table driven bytes permutation plus a
+	// directions permutation (a second lookup), with SSSE3 / AVX2 shuffles if the compiler targets them (scalar otherwise)
+	class CubeLanes
+	{
+	public:
+		CubeLanes() { std::call_once(TablesFlag, InitTables); Reset(); } // Solved state constructor
+		explicit CubeLanes(const Cube& C) { std::call_once(TablesFlag, InitTables); Set(C); } // Constructor from a cube
+
+		void Reset(); // Solved state with default spin
+		void Set(const Cube&); // Copy the cube state
+
+		// Apply a step (the same movements than in the cube for the current spin)
+		// Returns false if the step is a close parentheses with more than one repetition
+		bool ApplyStep(const Stp S)
+		{
+			const Cube::SpinStep& SS = (*SpinSteps)[static_cast<int>(Spin)][static_cast<int>(S)];
+			for (uint n = 0u; n < SS.Count; n++) Move(SS.Moves[n]);
+			Spin = SS.Spin;
+			return SS.Valid;
+		}
+
+		// Apply an algorithm (it should not have parentheses with more than one repetition, as in the cube)
+		// If there are parentheses with more than one repetition returns false and the state will be undefined
+		bool ApplyAlgorithm(const Algorithm&);
+
+		Cube GetCube() const; // Get the state as a cube
+
+		S64 GetEdgesStatus() const; // Get the edges status (as in the cube)
+		S64 GetCornersStatus() const; // Get the corners status (as in the cube)
+		Spn GetSpin() const { return Spin; } // Get the spin
+
+		// Check if the pieces in the given masks are solved (masks as in the cube)
+		bool IsSolved(const S64 EMask, const S64 CMask) const
+		{
+			return (GetEdgesStatus() & EMask) == (EdgesSolved & EMask) && (GetCornersStatus() & CMask) == (CornersSolved & CMask);
+		}
+
+		// Check if the pieces in the given lanes mask are solved
+		bool IsSolved(const LanesMask& M) const
+		{
+#if defined(__AVX2__)
+			const __m256i L = _mm256_and_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(Lanes)), _mm256_load_si256(reinterpret_cast<const __m256i*>(M.Mask)));
+			return _mm256_movemask_epi8(_mm256_cmpeq_epi8(L, _mm256_load_si256(reinterpret_cast<const __m256i*>(M.Solved)))) == -1;
+#elif defined(__SSSE3__)
+			const __m128i L0 = _mm_and_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(Lanes)), _mm_load_si128(reinterpret_cast<const __m128i*>(M.Mask))),
+						  L1 = _mm_and_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(Lanes + 16)), _mm_load_si128(reinterpret_cast<const __m128i*>(M.Mask + 16)));
+			const __m128i E = _mm_and_si128(_mm_cmpeq_epi8(L0, _mm_load_si128(reinterpret_cast<const __m128i*>(M.Solved))),
+											_mm_cmpeq_epi8(L1, _mm_load_si128(reinterpret_cast<const __m128i*>(M.Solved + 16))));
+			return _mm_movemask_epi8(E) == 0xFFFF;
+#else
+			uint8_t Diff = 0u;
+			for (uint n = 0u; n < 32u; n++) Diff |= (Lanes[n] & M.Mask[n]) ^ M.Solved[n];
+			return Diff == 0u;
+#endif
+		}
+
+		static const char* GetKernel(); // Name of the movements code used (AVX2, SSSE3 or scalar)
+
+	private:
+		alignas(32) uint8_t Lanes[32]; // Edges lanes (0 to 11) and corners lanes (16 to 23), unused lanes are zero
+		Spn Spin; // Cube spin
+
+		static S64 EdgesSolved, CornersSolved; // Solved status
+
+		// Lanes permutation (source lane in the same 16 bytes half) and directions map (map index * 4) in each lane for each
+		// physical movement (0 to 17, same order than in Stp enumeration)
+		alignas(32) static uint8_t Perms[18][32], Maps[18][32];
+
+		// New direction (* 16) for each direction map and direction: a movement keeps the directions or swaps two of them
+		// (the directions are the axis of the piece sticker, an edge flip swaps directions 0 and 1)
+		alignas(32) static const uint8_t DirMaps[32];
+		static const Cube::SpinStepsTable* SpinSteps; // Physical movements for each step in each spin (from the cube)
+		static std::once_flag TablesFlag;
+
+		static void InitTables(); // Movements tables initialization
+
+		friend struct LanesMask;
+
+		void Move(const uint m) // Apply a physical movement
+		{
+#if defined(__AVX2__)
+			const __m256i Low = _mm256_set1_epi8(0x0F), Dir = _mm256_set1_epi8(0x03);
+			const __m256i L = _mm256_load_si256(reinterpret_cast<const __m256i*>(Lanes));
+			const __m256i P = _mm256_shuffle_epi8(L, _mm256_load_si256(reinterpret_cast<const __m256i*>(Perms[m])));
+			const __m256i D = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(P, 4), Dir), _mm256_load_si256(reinterpret_cast<const __m256i*>(Maps[m])));
+			const __m256i N = _mm256_shuffle_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(DirMaps)), D);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(Lanes), _mm256_or_si256(_mm256_and_si256(P, Low), N));
+#elif defined(__SSSE3__)
+			const __m128i Low = _mm_set1_epi8(0x0F), Dir = _mm_set1_epi8(0x03);
+			const __m128i DM = _mm_load_si128(reinterpret_cast<const __m128i*>(DirMaps));
+			for (uint h = 0u; h < 32u; h += 16u)
+			{
+				const __m128i L = _mm_load_si128(reinterpret_cast<const __m128i*>(Lanes + h));
+				const __m128i P = _mm_shuffle_epi8(L, _mm_load_si128(reinterpret_cast<const __m128i*>(Perms[m] + h)));
+				const __m128i D = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(P, 4), Dir), _mm_load_si128(reinterpret_cast<const __m128i*>(Maps[m] + h)));
+				_mm_store_si128(reinterpret_cast<__m128i*>(Lanes + h), _mm_or_si128(_mm_and_si128(P, Low), _mm_shuffle_epi8(DM, D)));
+			}
+#else
+			uint8_t Aux[32];
+			for (uint n = 0u; n < 32u; n++)
+			{
+				const uint8_t P = Lanes[(n & 0x10u) | Perms[m][n]];
+				Aux[n] = static_cast<uint8_t>((P & 0x0Fu) | DirMaps[Maps[m][n] | (P >> 4)]);
+			}
+			for (uint n = 0u; n < 32u; n++) Lanes[n] = Aux[n];
+#endif
+		}
+	};
+}
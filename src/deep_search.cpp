@@ -22,12 +22,52 @@
 
 #include <thread>
 #include <mutex>
+#include <chrono>
+#include <algorithm>
 
 #include "deep_search.h"
 
 namespace grcube3
 {
     uint SearchUnit::UnitsAmount = 0u;
+
+	// Build the successor steps table for the given steps list
+	void SuccessorSteps::Update(const std::vector<Stp>& SL, const bool Commute)
+	{
+		Steps.clear();
+		for (uint n = 0u; n < StepsAmount; n++)
+		{
+			Start[n] = static_cast<uint>(Steps.size());
+			for (const auto S : SL) if (IsCanonical(static_cast<Stp>(n), S, Commute)) Steps.push_back(S);
+		}
+		Start[StepsAmount] = static_cast<uint>(Steps.size());
+	}
+
+	// Check if a step is a canonical successor of the last step
+	bool SuccessorSteps::IsCanonical(const Stp Last, const Stp S, const bool Commute)
+	{
+		Stp JoinedStep;
+		if (Algorithm::JoinSteps(Last, S, JoinedStep)) return false; // Steps in the same layer are joined
+		if (Algorithm::OppositeSteps(Last, S) && Last > S) return false; // "... U D ..." is the same than "... D U ..."
+		// Steps in the same axis commute ("R M L" = "L R M" = ...), only the order U-D-u-d-E (F-B-f-b-S, R-L-r-l-M) is allowed
+		if (Commute && Last > Stp::NONE && Last < Stp::x && S > Stp::NONE && S < Stp::x && Algorithm::SameAxisSteps(Last, S) &&
+			(static_cast<uint>(Last) - 1u) / 3u > (static_cast<uint>(S) - 1u) / 3u) return false;
+		return true;
+	}
+
+	static thread_local uint WorkerIndex = 0u; // Index of the search thread running in the current thread
+	static thread_local S64 ThreadNodes = 0ull; // Search nodes visited in the current thread
+	static thread_local S64 ThreadHits = 0ull, ThreadMisses = 0ull; // Transposition table hits and misses in the current thread
+
+	// Check if the search must be stopped (the deadline and the token are checked only every few nodes)
+	inline bool DeepSearch::Stopped()
+	{
+		if (Truncated.load(std::memory_order_relaxed)) return true;
+		if ((ThreadNodes & StopCheckNodes) != 0ull) return false;
+		if ((CancelToken != nullptr && CancelToken->load(std::memory_order_relaxed)) || std::chrono::steady_clock::now() >= Deadline)
+			Truncated = true;
+		return Truncated;
+	}
 	
 	// Algorithm search class constructor
     DeepSearch::DeepSearch(const Algorithm& scr, const Plc Pol) // Scramble to start the search
@@ -40,6 +80,21 @@ namespace grcube3
 		MandatorySolveMask.Clear();
 		OptionalSolveMasks.clear();
 		MandatoryOrientedPos.clear();
+		PruningEnabled = Pruning = false;
+		BidirectionalEnabled = Bidirectional = false;
+		ForwardSteps = BackwardSteps = 0u;
+		BackwardNodes = 0ull;
+		PendingTasks = IdleWorkers = 0u;
+		SolveFound = false;
+		Deadline = std::chrono::steady_clock::time_point::max();
+		CancelToken = nullptr;
+		Truncated = false;
+		Transpositions = nullptr;
+		TranspositionGeneration = 0u;
+		TranspositionHits = TranspositionMisses = 0ull;
+		Nodes = 0ull;
+		SearchTime = 0.0;
+		BatchSize = 0u;
         SetNewScramble(scr); // Apply the scramble
 	}
 
@@ -123,6 +178,26 @@ namespace grcube3
         for (const auto P : AuxPiecesList) AddToMandatoryPositions(P);
 	}
 
+	// Add a search level
+	// If the single steps differ from the previous level, the commuting steps in the same axis are not ordered
+	void DeepSearch::AddSearchLevel(const SearchLevel& SL)
+	{
+		// Sorted single steps in all units of a level
+		auto GetSingleSteps = [](const SearchLevel& L)
+		{
+			std::vector<Stp> Steps;
+			for (const auto& U : L.Unit) if (U.Type == SequenceType::SINGLE) Steps.insert(Steps.end(), U.MainSteps.begin(), U.MainSteps.end());
+			std::sort(Steps.begin(), Steps.end());
+			Steps.erase(std::unique(Steps.begin(), Steps.end()), Steps.end());
+			return Steps;
+		};
+
+		Levels.push_back(SL);
+		if (Levels.size() > 1u && GetSingleSteps(Levels[Levels.size() - 2u]) != GetSingleSteps(Levels.back()))
+			for (auto& U : Levels.back().Unit) U.NextMainSteps.Update(U.MainSteps, false);
+		MaxSearchDeep = static_cast<uint>(Levels.size());
+	}
+
 	// Updates root algorithms and sequence data
 	// All units in level 0 are developed
 	bool DeepSearch::UpdateRootData()
@@ -226,41 +301,478 @@ namespace grcube3
 	// Run the search -> -1: use no threads, 0: use all threads avaliable, other: use specified number of threads
 	void DeepSearch::Run(const int UseThreads)
 	{
-		if (RootBranches == 0u) return;
+		if (RootBranches == 0u || GetMaxSteps() > SearchSteps::Capacity) return;
+
+		UpdatePruningData();
+
+		Workers.clear();
+		PendingTasks = IdleWorkers = 0u;
+		SolveFound = !Solves.empty();
+		Truncated = false;
+		Nodes = 0ull;
+		SearchTime = 0.0;
+		TranspositionHits = TranspositionMisses = 0ull;
+		if (Transpositions != nullptr) TranspositionGeneration = Transpositions->NewSearch();
+
+		if ((CancelToken != nullptr && *CancelToken) || std::chrono::steady_clock::now() >= Deadline) // No time to search
+		{
+			Truncated = true;
+			return;
+		}
+
+		const auto time_search_start = std::chrono::system_clock::now();
 		
-		if (UseThreads >= 0) // Multithreading
+		if (UpdateBidirectionalData()) RunBidirectional(UseThreads); // Meet in the middle search
+		else if (UseThreads >= 0) // Multithreading
 		{
 			UsedCores = (UseThreads == 0) || (UseThreads >= Cores) ? Cores : UseThreads;
 
-			std::vector<std::thread> Pool; // Threads pool
+			// Root branches are distributed among threads, idle threads will steal tasks from busy threads
+			for (uint nc = 0u; nc < UsedCores; nc++) Workers.push_back(std::unique_ptr<SearchWorker>(new SearchWorker));
+			for (uint n = 0u; n < RootBranches; n++)
+			{
+				Cube CubeRoot = CubeBase; // The cube state goes down the search tree with each branch
+				CubeRoot.ApplyAlgorithm(Roots[n]);
+				SearchSteps Steps(Roots[n]);
+				Steps.PushBranch(n);
+				Workers[n % UsedCores]->Tasks.push_back({ Steps, CubeRoot, 0u, 0u, 0u });
+			}
+			PendingTasks = RootBranches;
+
+			ThreadPool::Get().Run(UsedCores, [this](const uint nc) { RunThread(nc); }); // A thread per core (waits for all threads)
 
-			for (uint nc = 0; nc < UsedCores; nc++) Pool.push_back(std::thread(&DeepSearch::RunThread, this, nc)); // Add a thread per core
-            for (auto& t : Pool) t.join(); // Wait for all threads
+			for (const auto& W : Workers)
+			{
+				Nodes += W->Nodes;
+				TranspositionHits += W->Hits;
+				TranspositionMisses += W->Misses;
+			}
+
+			MergeSolves(); // Solves from all threads in depth-first order
 		}
         else // Without multithreading (for debugging, slower)
 		{
-            for (const auto& R : Roots) RunSearch(R, 0u, 0u, 0u);
+			ThreadNodes = ThreadHits = ThreadMisses = 0ull;
+            for (const auto& R : Roots)
+			{
+				Cube CubeRoot = CubeBase;
+				CubeRoot.ApplyAlgorithm(R);
+				SearchSteps Steps(R);
+				RunSearch(Steps, CubeRoot, 0u, 0u, 0u);
+			}
+			Nodes = ThreadNodes;
+			TranspositionHits = ThreadHits;
+			TranspositionMisses = ThreadMisses;
 			UsedCores = -1;
 		}
+
+		const std::chrono::duration<double> search_elapsed_seconds = std::chrono::system_clock::now() - time_search_start;
+		SearchTime = search_elapsed_seconds.count();
+		for (auto& W : Workers) W->IdleTime = SearchTime > W->BusyTime ? SearchTime - W->BusyTime : 0.0;
+	}
+
+	// Run the search for a batch of scrambles: the search tree is walked only once, and each node is checked for all the
+	// scrambles still alive in his branch (the search scramble is restored after the search)
+	// The solves for each scramble are the same, and in the same order, than the solves of a single scramble search
+	void DeepSearch::RunBatch(const std::vector<Algorithm>& BatchScrambles, // Scrambles to search
+							  std::vector<std::vector<Algorithm>>& BatchSolves, // Solves found for each scramble
+							  const int UseThreads) // -1: use no threads, 0: use all threads avaliable, other: use specified number of threads
+	{
+		BatchSolves.assign(BatchScrambles.size(), std::vector<Algorithm>());
+		BatchSize = static_cast<uint>(BatchScrambles.size());
+		SearchTime = 0.0;
+
+		if (BatchScrambles.empty() || RootBranches == 0u || GetMaxSteps() > SearchSteps::Capacity) return;
+
+		const auto time_batch_start = std::chrono::system_clock::now();
+
+		const Algorithm SearchScramble = Scramble;
+		const std::vector<Algorithm> SearchSolves = Solves;
+
+		BatchCubes.clear();
+		bool SameSpin = true; // The bidirectional search pieces movements are valid for all scrambles
+		for (const auto& S : BatchScrambles)
+		{
+			BatchCubes.push_back(Cube(S));
+			if (BatchCubes.back().GetSpin() != BatchCubes[0].GetSpin()) SameSpin = false;
+		}
+
+		SetNewScramble(BatchScrambles[0]);
+		UpdatePruningData();
+
+		Workers.clear();
+		PendingTasks = IdleWorkers = 0u;
+		SolveFound = false;
+		Truncated = false;
+		Nodes = 0ull;
+		TranspositionHits = TranspositionMisses = 0ull;
+
+		if ((CancelToken != nullptr && *CancelToken) || std::chrono::steady_clock::now() >= Deadline) // No time to search
+		{
+			Truncated = true;
+			SetNewScramble(SearchScramble);
+			return;
+		}
+
+		const bool BatchBidirectional = SameSpin && UpdateBidirectionalData(),
+				   BatchPruning = Pruning && SearchPolicy == Plc::BEST_SOLVES && MinSearchDeep == 0u;
+
+		if (BatchBidirectional || BatchPruning) // A single search tree for all scrambles
+		{
+			UsedCores = UseThreads < 0 ? -1 : (UseThreads == 0) || (UseThreads >= Cores) ? Cores : UseThreads;
+			const uint Threads = UseThreads < 0 ? 1u : UsedCores;
+
+			for (uint nc = 0u; nc < Threads; nc++) Workers.push_back(std::unique_ptr<SearchWorker>(new SearchWorker));
+
+			if (Threads == 1u) RunBatchThread(0u, BatchBidirectional);
+			else ThreadPool::Get().Run(Threads, [this, BatchBidirectional](const uint nc) { RunBatchThread(nc, BatchBidirectional); });
+
+			Nodes = BatchBidirectional ? BackwardNodes : 0ull;
+			for (const auto& W : Workers) Nodes += W->Nodes;
+
+			if (BatchBidirectional) // Solves for each scramble in depth-first order (repeated solves removed)
+			{
+				std::vector<std::pair<uint, S64>> Joins;
+				for (auto& W : Workers)
+				{
+					Joins.insert(Joins.end(), W->BatchJoins.begin(), W->BatchJoins.end());
+					W->BatchJoins.clear();
+				}
+				std::sort(Joins.begin(), Joins.end());
+				Joins.erase(std::unique(Joins.begin(), Joins.end()), Joins.end());
+				for (const auto& J : Joins) BatchSolves[J.first].push_back(GetJoinSolve(J.second));
+
+				HalfTables.clear(); // Free the backward sequences memory
+			}
+			else // Each root branch is searched by a single thread, so the solves in a root branch are in depth-first order
+			{
+				std::vector<std::vector<BatchSolve>*> RootSolves(RootBranches, nullptr);
+				for (uint n = 0u; n < RootBranches; n++) RootSolves[n] = &Workers[n % Workers.size()]->BatchSolves;
+				std::vector<uint> Next(Workers.size(), 0u); // Next solve to merge from each thread
+				for (uint n = 0u; n < RootBranches; n++)
+				{
+					const std::vector<BatchSolve>& WS = *RootSolves[n];
+					uint& i = Next[n % Workers.size()];
+					for (; i < WS.size() && WS[i].Root == n; i++) BatchSolves[WS[i].Scramble].push_back(WS[i].Alg);
+				}
+				for (auto& W : Workers) W->BatchSolves.clear();
+			}
+		}
+		else // The search can't be shared, search each scramble
+		{
+			for (uint n = 0u; n < BatchScrambles.size() && !Truncated; n++)
+			{
+				SetNewScramble(BatchScrambles[n]);
+				Solves.clear();
+				Run(UseThreads);
+				BatchSolves[n] = Solves;
+			}
+		}
+
+		SetNewScramble(SearchScramble);
+		Solves = SearchSolves;
+		BatchCubes.clear();
+
+		const std::chrono::duration<double> batch_elapsed_seconds = std::chrono::system_clock::now() - time_batch_start;
+		SearchTime = batch_elapsed_seconds.count();
+		for (auto& W : Workers) W->IdleTime = SearchTime > W->BusyTime ? SearchTime - W->BusyTime : 0.0;
+	}
+
+	// Batch search thread (root branches are distributed among threads, each branch is searched for all scrambles)
+	void DeepSearch::RunBatchThread(const uint NCore, const bool BatchBidirectional)
+	{
+		const auto time_thread_start = std::chrono::system_clock::now();
+
+		WorkerIndex = NCore;
+		ThreadNodes = 0ull;
+		SearchWorker& W = *Workers[NCore];
+
+		if (BatchBidirectional) W.BatchStates.resize(ForwardSteps + 1u);
+		else
+		{
+			W.BatchCubes.resize(GetMaxSteps() + 1u);
+			W.BatchIds.resize(GetMaxSteps() + 1u);
+		}
+
+		for (uint n = NCore; n < RootBranches; n += static_cast<uint>(Workers.size()))
+		{
+			const uint RootSize = Roots[n].GetSize();
+			SearchSteps Steps(Roots[n]);
+
+			if (BatchBidirectional)
+			{
+				std::vector<PiecesState>& States = W.BatchStates[RootSize];
+				States.clear();
+				for (const auto& C : BatchCubes)
+				{
+					PiecesState S = PiecesMoves::GetState(C);
+					for (uint s = 0u; s < RootSize; s++) Moves.Apply(S, Roots[n].At(s));
+					States.push_back(S);
+				}
+				ForwardSearchBatch(Steps, static_cast<S64>(n + 1u) << (TailSteps * OrderBits), W);
+			}
+			else
+			{
+				W.BatchCubes[RootSize] = BatchCubes;
+				W.BatchIds[RootSize].clear();
+				for (uint i = 0u; i < BatchCubes.size(); i++)
+				{
+					W.BatchCubes[RootSize][i].ApplyAlgorithm(Roots[n]);
+					W.BatchIds[RootSize].push_back(i);
+				}
+				RunSearchBatch(Steps, 0u, n, W);
+			}
+		}
+
+		W.Nodes = ThreadNodes;
+		const std::chrono::duration<double> thread_elapsed_seconds = std::chrono::system_clock::now() - time_thread_start;
+		W.BusyTime = thread_elapsed_seconds.count();
+	}
+
+	// Search a branch for all the scrambles still alive in the branch (pruning tables search)
+	// The cubes and scrambles indexes for the current node are in the thread buffers for the current number of steps
+	void DeepSearch::RunSearchBatch(SearchSteps& Alg, // Current search algorithm
+									uint Deep, // Current search deep
+									const uint Root, // Root branch index
+									SearchWorker& W) // Thread data
+	{
+		ThreadNodes++;
+
+		if (Stopped()) return; // Deadline reached or search cancelled
+
+		const uint Size = Alg.GetSize();
+		std::vector<Cube>& Cubes = W.BatchCubes[Size];
+		std::vector<uint>& Ids = W.BatchIds[Size];
+
+		uint Alive = 0u; // Scrambles that can be solved in the remaining levels
+		for (uint i = 0u; i < Cubes.size(); i++)
+		{
+			const uint LowerBound = GetLowerBound(Cubes[i]);
+			if (LowerBound > 0u && LowerBound + Deep >= MaxSearchDeep) continue; // The pieces can't be solved in the remaining levels
+
+			if (LowerBound == 0u && Levels[Deep].Check == SearchCheck::CHECK && IsSolve(Cubes[i]))
+				W.BatchSolves.push_back({ Root, Ids[i], Alg.GetAlgorithm() });
+
+			if (Alive != i) { Cubes[Alive] = Cubes[i]; Ids[Alive] = Ids[i]; }
+			Alive++;
+		}
+		Cubes.resize(Alive);
+		Ids.resize(Alive);
+
+		if (Alive == 0u || ++Deep >= MaxSearchDeep) return;
+
+		std::vector<Cube>& NextCubes = W.BatchCubes[Size + 1u];
+
+		for (const auto& U : Levels[Deep].Unit) // With pruning tables all search levels are single steps
+		{
+			for (const auto S : U.NextMainSteps.Get(Alg.Last()))
+			{
+				if (Alg.ShrinksPenultimate(S)) continue;
+				NextCubes = Cubes;
+				for (auto& C : NextCubes) C.ApplyStep(S);
+				W.BatchIds[Size + 1u] = Ids;
+				Alg.Push(S);
+				RunSearchBatch(Alg, Deep, Root, W); // Recursive
+				Alg.Pop();
+			}
+		}
+	}
+
+	// Forward search for all scrambles, each node is joined with the backward sequences for each scramble state
+	// The pieces states for the current node are in the thread buffers for the current number of steps
+	void DeepSearch::ForwardSearchBatch(SearchSteps& A, // Current forward algorithm
+										const S64 Order, // Order key for the forward algorithm
+										SearchWorker& W) // Thread data
+	{
+		ThreadNodes++;
+
+		if (Stopped()) return; // Deadline reached or search cancelled
+
+		const uint Size = A.GetSize();
+		const std::vector<PiecesState>& States = W.BatchStates[Size];
+
+		for (uint i = 0u; i < States.size(); i++)
+		{
+			JoinHalves(A, States[i], Order, W.Joins);
+			for (const auto J : W.Joins) W.BatchJoins.push_back({ i, J });
+			W.Joins.clear();
+		}
+
+		if (Size >= ForwardSteps) return;
+
+		const uint Tail = TailSteps + Roots[0].GetSize() - Size; // Steps after the current algorithm
+		std::vector<PiecesState>& NextStates = W.BatchStates[Size + 1u];
+
+		for (const auto Step : Levels[0].Unit[0].NextMainSteps.Get(A.Last())) // All levels have the same steps
+		{
+			if (A.ShrinksPenultimate(Step)) continue;
+			NextStates = States;
+			for (auto& S : NextStates) Moves.Apply(S, Step);
+			A.Push(Step);
+			ForwardSearchBatch(A, Order | (static_cast<S64>(StepsIndex[static_cast<uint>(Step)] + 1u) << ((Tail - 1u) * OrderBits)), W); // Recursive
+			A.Pop();
+		}
 	}
 	
-    // Run search a thread
-    void DeepSearch::RunThread(const uint NCore) { for (uint n = NCore; n < RootBranches; n += UsedCores) RunSearch(Roots[n], 0u, 0u, 0u); }
-    
+	// Add the solves from all threads in depth-first order (the same order than in a search without threads)
+	void DeepSearch::MergeSolves()
+	{
+		std::vector<SearchSolve> ThreadsSolves;
+		for (auto& W : Workers)
+		{
+			for (auto& S : W->Solves) ThreadsSolves.push_back(std::move(S));
+			W->Solves.clear();
+		}
+		std::sort(ThreadsSolves.begin(), ThreadsSolves.end(),
+				  [](const SearchSolve& S1, const SearchSolve& S2) { return S1.Path < S2.Path; });
+		for (auto& S : ThreadsSolves) Solves.push_back(std::move(S.Alg));
+	}
+
+    // Run search a thread: own tasks first, then tasks stolen from other threads until all tasks are completed
+    void DeepSearch::RunThread(const uint NCore)
+	{
+		WorkerIndex = NCore;
+		ThreadNodes = ThreadHits = ThreadMisses = 0ull;
+		SearchWorker& W = *Workers[NCore];
+
+		SearchTask T;
+		bool Idle = false;
+
+		while (true)
+		{
+			if (GetTask(NCore, T))
+			{
+				if (Idle) { IdleWorkers--; Idle = false; }
+
+				const auto time_task_start = std::chrono::system_clock::now();
+				RunSearch(T.Steps, T.C, T.Deep, T.SeqId, T.SeqSize);
+				const std::chrono::duration<double> task_elapsed_seconds = std::chrono::system_clock::now() - time_task_start;
+				W.BusyTime += task_elapsed_seconds.count();
+
+				PendingTasks--;
+			}
+			else if (PendingTasks == 0u || Truncated) break; // Search completed or stopped (queued tasks are discarded)
+			else // Wait for a subtree split by other thread
+			{
+				if (!Idle) { IdleWorkers++; Idle = true; }
+				std::this_thread::yield();
+			}
+		}
+		if (Idle) IdleWorkers--;
+		W.Nodes = ThreadNodes;
+		W.Hits = ThreadHits;
+		W.Misses = ThreadMisses;
+	}
+
+	// Get a task from the own queue (front) or steal it from the back of other thread queue
+	bool DeepSearch::GetTask(const uint NCore, SearchTask& T)
+	{
+		{
+			SearchWorker& W = *Workers[NCore];
+			std::lock_guard<std::mutex> guard(W.TasksMutex);
+			if (!W.Tasks.empty())
+			{
+				T = W.Tasks.front();
+				W.Tasks.pop_front();
+				return true;
+			}
+		}
+
+		for (uint n = 1u; n < Workers.size(); n++)
+		{
+			SearchWorker& V = *Workers[(NCore + n) % Workers.size()];
+			std::lock_guard<std::mutex> guard(V.TasksMutex);
+			if (!V.Tasks.empty())
+			{
+				T = V.Tasks.back();
+				V.Tasks.pop_back();
+				Workers[NCore]->StolenTasks++;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Search a branch, or queue a copy if there are idle threads (only one split branch queued per thread)
+	inline void DeepSearch::Branch(SearchSteps& A, const Cube& C, const uint D, const uint SeqId, const uint SeqSize)
+	{
+		if (IdleWorkers > 0u && D + SplitMinLevels < MaxSearchDeep)
+		{
+			SearchWorker& W = *Workers[WorkerIndex];
+			std::lock_guard<std::mutex> guard(W.TasksMutex);
+			if (W.Tasks.empty())
+			{
+				PendingTasks++;
+				W.Tasks.push_back({ A, C, D, SeqId, SeqSize });
+				W.SplitTasks++;
+				return;
+			}
+		}
+		RunSearch(A, C, D, SeqId, SeqSize);
+	}
+
+	// Get the threads busy / idle times report
+	std::string DeepSearch::GetThreadsReport() const
+	{
+		std::string Report;
+		for (uint n = 0u; n < Workers.size(); n++)
+		{
+			Report += "\tThread " + std::to_string(n) + ": busy " + std::to_string(Workers[n]->BusyTime) + " s, idle " +
+					  std::to_string(Workers[n]->IdleTime) + " s (" + std::to_string(Workers[n]->StolenTasks) + " stolen tasks, " +
+					  std::to_string(Workers[n]->SplitTasks) + " split tasks, " + std::to_string(Workers[n]->Nodes) + " nodes)\n";
+		}
+		if (!Workers.empty()) Report += "\tSearch speed: " + std::to_string(static_cast<S64>(GetNodesPerSecond())) + " nodes/s\n";
+		if (TranspositionHits + TranspositionMisses > 0ull) Report += "\tTransposition table: " + std::to_string(TranspositionHits) +
+																	  " hits, " + std::to_string(TranspositionMisses) + " misses\n";
+		return Report;
+	}
+	
+	// Check if the same node (cube state, depth, last two steps and sequence position) has been searched before (always
+	// false without transposition table). The last two steps give the successors of the node (canonical steps and shrinks)
+	// The nodes in the last level are not stored: they have no subtree to save and the table would be filled with them
+	inline bool DeepSearch::Revisited(const SearchSteps& Alg, const Cube& C, const uint Deep, const uint SeqId, const uint SeqSize)
+	{
+		if (Transpositions == nullptr || Transpositions->Empty() || Deep + 1u >= MaxSearchDeep) return false;
+		if (Transpositions->Visit(C, Deep, Alg.Last(), Alg.Penultimate(), SeqId, SeqSize, TranspositionGeneration)) { ThreadHits++; return true; }
+		ThreadMisses++;
+		return false;
+	}
+
 	// Recursive search code
-    void DeepSearch::RunSearch(const Algorithm& Alg, // Current search algorithm
+    void DeepSearch::RunSearch(SearchSteps& Alg, // Current search algorithm (steps are pushed and popped in the recursion)
+							   const Cube& C, // Cube with the scramble and the current search algorithm applied
 							   uint Deep, // Current search deep
                                const uint SeqId, // Current sequence identifier (0 means root sequence or not in a sequence)
                                uint SeqSize) // Current sequence size
 	{
+		ThreadNodes++;
+
+		if (Stopped()) return; // Deadline reached or search cancelled
+
+		if (Pruning) // With pruning tables all search levels are single steps (no sequences)
+		{
+			if (Revisited(Alg, C, Deep, SeqId, SeqSize)) return; // The same node has been searched before
+			const uint LowerBound = GetLowerBound(C);
+			if (LowerBound > 0u && LowerBound + Deep >= MaxSearchDeep) return; // The pieces can't be solved in the remaining levels
+
+			if (LowerBound == 0u && Levels[Deep].Check == SearchCheck::CHECK) CheckSolve(Alg, C);
+
+			if (IncCheckDeep(Deep)) return; // It's no necessary to continue the search
+
+			NextLevel(Alg, C, Deep, true); // Prepare the branches for the next level of the search
+			return;
+		}
+
 		if (SeqId == 0u) // Root or not in a sequence
 		{
+			if (Revisited(Alg, C, Deep, SeqId, SeqSize)) return; // The same node has been searched before
+
 			// Check if current algorithm solves the pieces
-			if (Levels[Deep].Check == SearchCheck::CHECK) CheckSolve(Alg);
+			if (Levels[Deep].Check == SearchCheck::CHECK) CheckSolve(Alg, C);
 			
 			if (IncCheckDeep(Deep)) return; // It's no necessary to continue the search
 
-			NextLevel(Alg, Deep); // Prepare the branches for the next level of the search
+			NextLevel(Alg, C, Deep); // Prepare the branches for the next level of the search
 		}
 			
         else for (const auto& U : Levels[Deep].Unit)
@@ -273,25 +785,38 @@ namespace grcube3
 
 					if (SeqSize >= 3u) // Check if sequence is completed
 					{
-						if (Levels[Deep].Check == SearchCheck::CHECK) CheckSolve(Alg); // Check if current algorithm solves the pieces
+						if (Revisited(Alg, C, Deep, SeqId, SeqSize)) return; // The same node has been searched before
+						if (Levels[Deep].Check == SearchCheck::CHECK) CheckSolve(Alg, C); // Check if current algorithm solves the pieces
 						if (IncCheckDeep(Deep)) return; // It's no necessary to continue the search
-						NextLevel(Alg, Deep); // Go to next level
+						NextLevel(Alg, C, Deep); // Go to next level
 					}
 					else // Sequence is not completed
 					{
 						if (++SeqSize == 2u)
 						{
+							uint Branches = 0u; // Branch index (depth-first order)
                             for (const auto S : U.MainSteps)
 							{
-								Algorithm Alg2 = Alg;
-                                if (!Alg2.AppendShrink(S)) RunSearch(Alg2, Deep, SeqId, SeqSize); // Recursive
+                                if (Alg.Shrinks(S)) continue;
+								Cube C2 = C;
+								C2.ApplyStep(S);
+								Alg.Push(S);
+								Alg.PushBranch(Branches++);
+                                RunSearch(Alg, C2, Deep, SeqId, SeqSize); // Recursive
+								Alg.PopBranch();
+								Alg.Pop();
 							}
 						}
 						else // Sequence size == 3u -> Add the last step
 						{
-							Algorithm Alg2 = Alg;
-							Alg2.Append(Alg.PenultimateInverted());
-                            RunSearch(Alg2, Deep, SeqId, SeqSize); // Recursive
+							const Stp S = Alg.PenultimateInverted();
+							Cube C2 = C;
+							C2.ApplyStep(S);
+							Alg.Push(S);
+							Alg.PushBranch(0u);
+                            RunSearch(Alg, C2, Deep, SeqId, SeqSize); // Recursive
+							Alg.PopBranch();
+							Alg.Pop();
 						}
 					}
 					break;
@@ -300,108 +825,586 @@ namespace grcube3
 
 					if (SeqSize >= 3u) // Check if sequence is completed
 					{
-						if (Levels[Deep].Check == SearchCheck::CHECK) CheckSolve(Alg); // Check if current algorithm solves the pieces
+						if (Revisited(Alg, C, Deep, SeqId, SeqSize)) return; // The same node has been searched before
+						if (Levels[Deep].Check == SearchCheck::CHECK) CheckSolve(Alg, C); // Check if current algorithm solves the pieces
 						if (IncCheckDeep(Deep)) return; // It's no necessary to continue the search
-						NextLevel(Alg, Deep); // Go to next level
+						NextLevel(Alg, C, Deep); // Go to next level
 					}
 					else // Sequence is not completed
 					{
 						if (++SeqSize == 2u)
 						{
-                            for (const auto& MA : U.MainAlgs)
+							uint Branches = 0u;
+                            for (uint n = 0u; n < U.MainAlgs.size(); n++)
 							{
-								Algorithm Alg2 = Alg;
-                                Alg2.Append(MA);
-                                RunSearch(Alg2, Deep, SeqId, SeqSize); // Recursive
+								const Algorithm& MA = U.MainAlgs[n];
+								Cube C2 = C;
+								C2.ApplyEffect(U.GetMainEffect(n, C.GetSpin()));
+                                Alg.Push(MA);
+								Alg.PushBranch(Branches++);
+                                RunSearch(Alg, C2, Deep, SeqId, SeqSize); // Recursive
+								Alg.PopBranch();
+								Alg.Pop(MA.GetSize());
 							}
 						}
 						else // Sequence size == 3u -> Add the last step
 						{
-							Algorithm Alg2 = Alg;
-							Alg2.Append(Alg.PenultimateInverted());
-                            RunSearch(Alg2, Deep, SeqId, SeqSize); // Recursive
+							const Stp S = Alg.PenultimateInverted();
+							Cube C2 = C;
+							C2.ApplyStep(S);
+							Alg.Push(S);
+							Alg.PushBranch(0u);
+                            RunSearch(Alg, C2, Deep, SeqId, SeqSize); // Recursive
+							Alg.PopBranch();
+							Alg.Pop();
 						}
 					}
 					break;
 				
 				default: // Not into a sequence
 					
+					if (Revisited(Alg, C, Deep, SeqId, SeqSize)) return; // The same node has been searched before
+
 					// Check if current algorithm solves the pieces
-					if (Levels[Deep].Check == SearchCheck::CHECK) CheckSolve(Alg);
+					if (Levels[Deep].Check == SearchCheck::CHECK) CheckSolve(Alg, C);
 				
 					if (IncCheckDeep(Deep)) return; // It's no necessary to continue the search
 
-					NextLevel(Alg, Deep); // Prepare the branches for the next level of the search
+					NextLevel(Alg, C, Deep, U.Type == SequenceType::SINGLE); // Prepare the branches for the next level of the search (a single step can be reordered)
 					break;
 				}
 			}
 		}
     }
 	
-	// Check if an algorithm solves the pieces
-    inline void DeepSearch::CheckSolve(const Algorithm& A)
+	// Check if an algorithm solves the pieces (the algorithm is already applied to the given cube)
+    inline void DeepSearch::CheckSolve(const SearchSteps& A, const Cube& CubeTest)
+	{
+		if (IsSolve(CubeTest)) AddSolve(A); // Solve algorithm found
+	}
+
+	// Check if the cube has the search pieces solved (mandatory + at least an optional if there are optional pieces)
+	inline bool DeepSearch::IsSolve(const Cube& CubeTest) const
+	{
+		if (!CubeTest.IsSolved(MandatorySolveMask.MaskE, MandatorySolveMask.MaskC) || // True if no mandatory pieces
+			!CubeTest.CheckOrientation(MandatoryOrientedPos)) return false;
+
+		if (OptionalSolveMasks.empty()) return true; // Only mandatory
+
+		for (const auto& O : OptionalSolveMasks) if (CubeTest.IsSolved(O.MaskE, O.MaskC)) return true;
+		return false;
+	}
+
+	// Add a solve to the current thread solves (no locks needed)
+	inline void DeepSearch::AddSolve(const SearchSteps& A)
+	{
+		if (SearchPolicy == Plc::SHORT) // Reduce the search deep for all threads
+		{
+			uint Deep = MaxSearchDeep;
+			while (A.GetSize() + 1u < Deep && !MaxSearchDeep.compare_exchange_weak(Deep, A.GetSize() + 1u));
+		}
+		if (!SolveFound) SolveFound = true;
+
+		if (Workers.size() <= 1u) Solves.push_back(A.GetAlgorithm()); // Single thread: solves are already in depth-first order
+		else Workers[WorkerIndex]->Solves.push_back({ A.GetPath(), A.GetAlgorithm() });
+	}
+	
+	// Get the maximum number of steps in a search algorithm (the longest unit in each level)
+	uint DeepSearch::GetMaxSteps() const
 	{
-		Cube CubeTest = CubeBase;
-		CubeTest.ApplyAlgorithm(A);
+		uint MaxSteps = 0u;
+		for (const auto& L : Levels)
+		{
+			uint LevelSteps = 0u;
+			for (const auto& U : L.Unit)
+			{
+				uint UnitSteps = 0u;
+				switch (U.Type)
+				{
+				case SequenceType::SINGLE: UnitSteps = 1u; break;
+				case SequenceType::DOUBLE: UnitSteps = 2u; break;
+				case SequenceType::TRIPLE: case SequenceType::RETURN_FIXED_SINGLE: UnitSteps = 3u; break;
+				case SequenceType::CONST: case SequenceType::RETURN_CONST:
+					for (const auto& MA : U.MainAlgs) if (MA.GetSize() > UnitSteps) UnitSteps = MA.GetSize();
+					if (U.Type == SequenceType::RETURN_CONST) UnitSteps += 2u;
+					break;
+				default: break;
+				}
+				if (UnitSteps > LevelSteps) LevelSteps = UnitSteps;
+			}
+			MaxSteps += LevelSteps;
+		}
+		return MaxSteps;
+	}
+
+	// Check if the pruning tables can be used in the search and get them
+	// Pruning tables are admissible only if each search level adds a single layer movement
+	bool DeepSearch::UpdatePruningData()
+	{
+		Pruning = false;
+		MandatoryTables.clear();
+		OptionalTables.clear();
+		MandatoryDistanceTables.clear();
+		OptionalDistanceTables.clear();
+
+		if (!PruningEnabled || Levels.empty()) return false;
+
+		for (uint l = 0u; l < Levels.size(); l++)
+		{
+			for (const auto& U : Levels[l].Unit)
+			{
+				if (U.Type != SequenceType::SINGLE &&
+					(l > 0u || (U.Type != SequenceType::DOUBLE && U.Type != SequenceType::TRIPLE))) return false;
+				for (const auto S : U.MainSteps) if (!Algorithm::IsSingleMov(S)) return false;
+			}
+		}
+
+		// The distance tables files are used for the pieces they cover, and the pruning tables are generated for the rest
+		MasksPair Covered;
+		GetDistanceTables(MandatorySolveMask, MasksPair(), MandatoryDistanceTables, Covered);
+		PruningTable::GetTables(MandatorySolveMask.MaskE & ~Covered.MaskE, MandatorySolveMask.MaskC & ~Covered.MaskC, MandatoryTables);
+
+		bool OptionalPruning = !OptionalSolveMasks.empty();
+		for (const auto& O : OptionalSolveMasks)
+		{
+			// An optional group is solved with the mandatory pieces, so a table can cover pieces of both
+			std::vector<const PruningTable*> OTables;
+			std::vector<const DistanceTable*> ODTables;
+			Covered.Clear();
+			GetDistanceTables(MasksPair(O.MaskE | MandatorySolveMask.MaskE, O.MaskC | MandatorySolveMask.MaskC), MandatorySolveMask, ODTables, Covered);
+			PruningTable::GetTables(O.MaskE & ~Covered.MaskE, O.MaskC & ~Covered.MaskC, OTables);
+			if (OTables.empty() && ODTables.empty()) OptionalPruning = false; // An optional group without tables always has a zero lower bound
+			OptionalTables.push_back(OTables);
+			OptionalDistanceTables.push_back(ODTables);
+		}
+		if (!OptionalPruning)
+		{
+			OptionalTables.clear();
+			OptionalDistanceTables.clear();
+		}
 
-        if (CubeTest.IsSolved(MandatorySolveMask.MaskE, MandatorySolveMask.MaskC) && // True if no mandatory pieces
-			CubeTest.CheckOrientation(MandatoryOrientedPos))
+		Pruning = !MandatoryTables.empty() || !MandatoryDistanceTables.empty() || !OptionalTables.empty();
+		return Pruning;
+	}
+
+	// Get the named distance tables from files for pieces inside the given pieces and not inside the excluded pieces, and
+	// the masks for the pieces covered by them. Only the 4 bits tables are used (the 2 bits tables are too slow to read in
+	// each search node), and the edges orientation tables are not used (the search orientation depends on the spin)
+	void DeepSearch::GetDistanceTables(const MasksPair& Pieces, const MasksPair& Excluded, std::vector<const DistanceTable*>& DTables, MasksPair& Covered)
+	{
+		for (const auto& Def : DistanceTable::GetDefinitions())
 		{
-			if (OptionalSolveMasks.empty()) // Solve algorithm found (only mandatory)
+			if (Def.EO) continue;
+
+			std::vector<Pcp> AuxPiecesList; // Table pieces positions list
+			std::vector<Edp> AuxEdgesList; // Table edges positions list
+			std::vector<Cnp> AuxCornersList; // Table corners positions list
+
+			Cube::AddToPositionsList(Def.Groups, AuxPiecesList);
+			for (const auto P : AuxPiecesList)
 			{
-				std::lock_guard<std::mutex> guard(SearchMutex);
-                if (SearchPolicy == Plc::SHORT && A.GetSize() < MaxSearchDeep) MaxSearchDeep = A.GetSize() + 1u;
-				Solves.push_back(A); // Thread safe code
+				if (Cube::IsEdge(P)) AuxEdgesList.push_back(Cube::PcpToEdp(P));
+				else if (Cube::IsCorner(P)) AuxCornersList.push_back(Cube::PcpToCnp(P));
 			}
-			else // Check solve algorithm found (mandatory + at least an optional)
+			const S64 MaskE = Cube::GetMaskSolvedEdges(AuxEdgesList), MaskC = Cube::GetMaskSolvedCorners(AuxCornersList);
+
+			if ((MaskE & ~Pieces.MaskE) != 0ull || (MaskC & ~Pieces.MaskC) != 0ull) continue; // Pieces not to solve
+			if ((MaskE & ~Excluded.MaskE) == 0ull && (MaskC & ~Excluded.MaskC) == 0ull) continue; // Only excluded pieces
+
+			const DistanceTable* T = DistanceTable::Get(Def.Name);
+			if (T == nullptr || T->GetBits() != 4u) continue; // Table file not found
+
+			DTables.push_back(T);
+			Covered.MaskE |= MaskE;
+			Covered.MaskC |= MaskC;
+		}
+	}
+
+	// Get the minimum number of movements needed to solve the mandatory pieces and at least one optional pieces group
+	uint DeepSearch::GetLowerBound(const Cube& C) const
+	{
+		uint8_t ESlots[12], CSlots[8];
+		PruningTable::GetEdgesSlots(C.GetEdgesStatus(), ESlots);
+		PruningTable::GetCornersSlots(C.GetCornersStatus(), CSlots);
+
+		uint LowerBound = 0u;
+		for (const auto T : MandatoryTables)
+		{
+			const uint Distance = T->GetDistance(T->GetType() == Pct::EDGE ? ESlots : CSlots);
+			if (Distance > LowerBound) LowerBound = Distance;
+		}
+		for (const auto T : MandatoryDistanceTables)
+		{
+			const uint Distance = T->GetDistance(C);
+			if (Distance > LowerBound) LowerBound = Distance;
+		}
+
+		if (!OptionalTables.empty())
+		{
+			uint MinOptional = PruningTable::Unknown;
+			for (uint g = 0u; g < OptionalTables.size(); g++)
 			{
-				for (const auto& O : OptionalSolveMasks)
+				uint OptionalBound = 0u;
+				for (const auto T : OptionalTables[g])
+				{
+					const uint Distance = T->GetDistance(T->GetType() == Pct::EDGE ? ESlots : CSlots);
+					if (Distance > OptionalBound) OptionalBound = Distance;
+				}
+				for (const auto T : OptionalDistanceTables[g])
 				{
-					if (CubeTest.IsSolved(O.MaskE, O.MaskC))
-					{ // Solve algorithm found
-						std::lock_guard<std::mutex> guard(SearchMutex);
-                        if (SearchPolicy == Plc::SHORT && A.GetSize() < MaxSearchDeep) MaxSearchDeep = A.GetSize() + 1u;
-						Solves.push_back(A); // Thread safe code
-                        break;
+					const uint Distance = T->GetDistance(C);
+					if (Distance > OptionalBound) OptionalBound = Distance;
+				}
+				if (OptionalBound < MinOptional) MinOptional = OptionalBound;
+				if (MinOptional <= LowerBound) break; // Can't increase the lower bound
+			}
+			if (MinOptional > LowerBound) LowerBound = MinOptional;
+		}
+
+		return LowerBound;
+	}
+
+	// Check if the bidirectional search can be used and get the backward sequences from the solved pieces
+	// Needs the pruning tables conditions (single layer movements in all levels), a single unit with the same steps in
+	// each level, and pieces to solve that can be coded in a pieces state (full pieces, all or none edges oriented)
+	bool DeepSearch::UpdateBidirectionalData()
+	{
+		Bidirectional = false;
+		Targets.clear();
+		HalfTables.clear();
+		RelaxedTables.clear();
+		ForwardHalves.clear();
+		ForwardSteps = BackwardSteps = 0u;
+		BackwardNodes = 0ull;
+
+		if (!BidirectionalEnabled || !Pruning || SearchPolicy != Plc::BEST_SOLVES || MinSearchDeep > 0u) return false;
+
+		const std::vector<Stp>& MainSteps = Levels[0].Unit[0].MainSteps;
+		for (const auto& L : Levels) if (L.Unit.size() != 1u || L.Unit[0].MainSteps != MainSteps) return false;
+
+		const uint RootSteps = Roots[0].GetSize();
+		for (const auto& R : Roots) if (R.GetSize() != RootSteps) return false;
+
+		uint EOPositions = 0u; // Edges orientation
+		for (const auto P : MandatoryOrientedPos)
+		{
+			if (Cube::IsCorner(P)) return false;
+			if (Cube::IsEdge(P)) EOPositions |= 1u << static_cast<uint>(Cube::PcpToEdp(P));
+		}
+		if (EOPositions != 0u && EOPositions != 0xFFFu) return false;
+
+		if (OptionalSolveMasks.empty())
+		{
+			Targets.push_back(BidirectionalTarget());
+			if (!Targets.back().Set(MandatorySolveMask.MaskE, MandatorySolveMask.MaskC, EOPositions != 0u)) return false;
+		}
+		else for (const auto& O : OptionalSolveMasks)
+		{
+			Targets.push_back(BidirectionalTarget());
+			if (!Targets.back().Set(MandatorySolveMask.MaskE | O.MaskE, MandatorySolveMask.MaskC | O.MaskC, EOPositions != 0u)) return false;
+		}
+
+		if (!Moves.Update(CubeBase)) return false;
+		StartState = PiecesMoves::GetState(CubeBase);
+
+		// Targets that are a rotation of a previous target share his backward sequences (symmetry folding)
+		std::vector<uint> TableTargets; // Canonical target for each backward sequences table
+		std::vector<uint> Orbits; // Targets folded into each table
+		for (uint t = 0u; t < Targets.size(); t++)
+		{
+			bool Folded = false;
+			for (uint c = 0u; c < TableTargets.size() && !Folded; c++)
+			{
+				for (int sp = 0; sp < 24 && !Folded; sp++)
+				{
+					if (static_cast<Spn>(sp) == CubeBase.GetSpin()) continue;
+					const PiecesSymmetry* Sym = PiecesSymmetry::Get(CubeBase.GetSpin(), static_cast<Spn>(sp));
+					if (Sym == nullptr) continue;
+					bool SameSteps = true; // The symmetry must keep the search steps
+					for (const auto S : MainSteps)
+						if (std::find(MainSteps.begin(), MainSteps.end(), Sym->GetSourceStep(S)) == MainSteps.end()) SameSteps = false;
+					if (SameSteps) Folded = Targets[t].Fold(Targets[TableTargets[c]], Sym);
+				}
+			}
+			if (Folded) Orbits[Targets[t].Table]++;
+			else
+			{
+				Targets[t].Table = static_cast<uint>(TableTargets.size());
+				TableTargets.push_back(t);
+				Orbits.push_back(1u);
+			}
+		}
+		// The symmetry changes the steps order, so the canonical order can't be used in the shared tables
+		for (const auto O : Orbits) RelaxedTables.push_back(O > 1u);
+
+		StepsIndex.fill(0u);
+		for (uint n = 0u; n < MainSteps.size(); n++) StepsIndex[static_cast<uint>(MainSteps[n])] = n;
+
+		// Search lengths: the first half of the steps is searched forwards and the second half backwards
+		const uint MaxSteps = RootSteps + MaxSearchDeep - 1u;
+
+		// Solves are stored as order keys: root index + 1 and each next step index + 1 (zero after the last step)
+		TailSteps = MaxSteps - RootSteps;
+		uint RootBits = 0u;
+		while ((1ull << RootBits) <= RootBranches) RootBits++;
+		if (RootBits + TailSteps * OrderBits > 64u || MainSteps.size() >= (1u << OrderBits)) return false;
+
+		uint MaxBackwardSteps = 0u;
+		for (uint L = RootSteps; L <= MaxSteps; L++) MaxBackwardSteps = std::max(MaxBackwardSteps, std::min(L / 2u, L - RootSteps));
+		if (MaxBackwardSteps > HalfSearchTable::MaxSteps) MaxBackwardSteps = HalfSearchTable::MaxSteps;
+
+		// Backward sequences (the new step is added at the start of the sequence, the inverse step is applied to the state)
+		struct HalfNode { PiecesState S; uint Steps; };
+		std::vector<std::vector<HalfNode>> Layers(TableTargets.size(), { { PiecesState::Solved(), 0u } });
+		HalfTables.resize(TableTargets.size());
+		for (uint t = 0u; t < TableTargets.size(); t++)
+		{
+			HalfTables[t].resize(1u);
+			HalfTables[t][0].Build({ Targets[TableTargets[t]].GetKey(Layers[t][0].S) }, { 0u });
+		}
+		BackwardNodes = TableTargets.size();
+
+		std::vector<S64> Keys;
+		std::vector<uint> Steps;
+		while (BackwardSteps < MaxBackwardSteps)
+		{
+			std::vector<std::vector<HalfNode>> NextLayers(TableTargets.size());
+			S64 NextNodes = 0ull;
+			for (uint t = 0u; t < TableTargets.size() && BackwardNodes + NextNodes <= BidirectionalMaxEntries; t++)
+			{
+				for (const auto& N : Layers[t])
+				{
+					const Stp First = BackwardSteps > 0u ? HalfSearchTable::GetStep(N.Steps, 0u) : Stp::NONE,
+							  Second = BackwardSteps > 1u ? HalfSearchTable::GetStep(N.Steps, 1u) : Stp::NONE;
+					for (const auto S : MainSteps)
+					{
+						Stp JoinedStep;
+						if (First != Stp::NONE && (RelaxedTables[t] ? Algorithm::JoinSteps(S, First, JoinedStep) :
+																	  !SuccessorSteps::IsCanonical(S, First, true))) continue;
+						if (Second != Stp::NONE && Algorithm::JoinSteps(S, First, Second, JoinedStep)) continue;
+						HalfNode NN = { N.S, (N.Steps << HalfSearchTable::StepBits) | static_cast<uint>(S) };
+						Moves.Apply(NN.S, Algorithm::InvertedStep(S));
+						NextLayers[t].push_back(NN);
 					}
 				}
+				NextNodes += NextLayers[t].size();
+			}
+			if (BackwardNodes + NextNodes > BidirectionalMaxEntries) break; // Too much memory, the forward search will be deeper
+
+			for (uint t = 0u; t < TableTargets.size(); t++)
+			{
+				Keys.clear();
+				Steps.clear();
+				for (const auto& N : NextLayers[t]) { Keys.push_back(Targets[TableTargets[t]].GetKey(N.S)); Steps.push_back(N.Steps); }
+				HalfTables[t].push_back(HalfSearchTable());
+				HalfTables[t].back().Build(Keys, Steps);
 			}
+			BackwardNodes += NextNodes;
+			BackwardSteps++;
+			Layers.swap(NextLayers);
 		}
+
+		// Backward lengths to join for each forward length (only for check levels)
+		ForwardHalves.assign(MaxSteps + 1u, std::vector<uint>());
+		ForwardSteps = RootSteps;
+		for (uint L = RootSteps; L <= MaxSteps; L++)
+		{
+			if (Levels[L - RootSteps].Check != SearchCheck::CHECK) continue;
+			const uint h = std::min(std::min(L / 2u, L - RootSteps), BackwardSteps);
+			ForwardHalves[L - h].push_back(h);
+			if (L - h > ForwardSteps) ForwardSteps = L - h;
+		}
+
+		Bidirectional = true;
+		return true;
 	}
-	
+
+	// Run the bidirectional search: each thread searches forwards from his root branches
+	void DeepSearch::RunBidirectional(const int UseThreads)
+	{
+		UsedCores = UseThreads < 0 ? -1 : (UseThreads == 0) || (UseThreads >= Cores) ? Cores : UseThreads;
+		const uint Threads = UseThreads < 0 ? 1u : UsedCores;
+
+		for (uint nc = 0u; nc < Threads; nc++) Workers.push_back(std::unique_ptr<SearchWorker>(new SearchWorker));
+
+		if (Threads == 1u) RunBidirectionalThread(0u);
+		else ThreadPool::Get().Run(Threads, [this](const uint nc) { RunBidirectionalThread(nc); });
+
+		Nodes = BackwardNodes;
+		for (const auto& W : Workers) Nodes += W->Nodes;
+
+		// Solves from all threads in depth-first order (the same solve can be found more than once for different targets)
+		std::vector<S64> Joins;
+		for (auto& W : Workers)
+		{
+			Joins.insert(Joins.end(), W->Joins.begin(), W->Joins.end());
+			W->Joins.clear();
+		}
+		std::sort(Joins.begin(), Joins.end());
+		Joins.erase(std::unique(Joins.begin(), Joins.end()), Joins.end());
+
+		for (const auto J : Joins) Solves.push_back(GetJoinSolve(J));
+
+		HalfTables.clear(); // Free the backward sequences memory
+	}
+
+	// Forward search thread for the bidirectional search (root branches are distributed among threads)
+	void DeepSearch::RunBidirectionalThread(const uint NCore)
+	{
+		const auto time_thread_start = std::chrono::system_clock::now();
+
+		WorkerIndex = NCore;
+		ThreadNodes = 0ull;
+		SearchWorker& W = *Workers[NCore];
+
+		for (uint n = NCore; n < RootBranches; n += static_cast<uint>(Workers.size()))
+		{
+			PiecesState S = StartState;
+			for (uint s = 0u; s < Roots[n].GetSize(); s++) Moves.Apply(S, Roots[n].At(s));
+			SearchSteps Steps(Roots[n]);
+			ForwardSearch(Steps, S, static_cast<S64>(n + 1u) << (TailSteps * OrderBits), W.Joins);
+		}
+
+		W.Nodes = ThreadNodes;
+		const std::chrono::duration<double> thread_elapsed_seconds = std::chrono::system_clock::now() - time_thread_start;
+		W.BusyTime = thread_elapsed_seconds.count();
+	}
+
+	// Forward search, each node is joined with the backward sequences that reach the solved pieces from the node state
+	void DeepSearch::ForwardSearch(SearchSteps& A, // Current forward algorithm
+								   const PiecesState& S, // Pieces state with the scramble and the forward algorithm applied
+								   const S64 Order, // Order key for the forward algorithm
+								   std::vector<S64>& FSolves) // Solves found (order keys)
+	{
+		ThreadNodes++;
+
+		if (Stopped()) return; // Deadline reached or search cancelled
+
+		JoinHalves(A, S, Order, FSolves);
+
+		if (A.GetSize() >= ForwardSteps) return;
+
+		const uint Tail = TailSteps + Roots[0].GetSize() - A.GetSize(); // Steps after the current algorithm
+
+		for (const auto Step : Levels[0].Unit[0].NextMainSteps.Get(A.Last())) // All levels have the same steps
+		{
+			if (A.ShrinksPenultimate(Step)) continue;
+			PiecesState S2 = S;
+			Moves.Apply(S2, Step);
+			A.Push(Step);
+			ForwardSearch(A, S2, Order | (static_cast<S64>(StepsIndex[static_cast<uint>(Step)] + 1u) << ((Tail - 1u) * OrderBits)), FSolves); // Recursive
+			A.Pop();
+		}
+	}
+
+	// Join a forward node with the backward sequences that reach the solved pieces from the node state
+	void DeepSearch::JoinHalves(const SearchSteps& A, // Current forward algorithm
+								const PiecesState& S, // Pieces state with the scramble and the forward algorithm applied
+								const S64 Order, // Order key for the forward algorithm
+								std::vector<S64>& FSolves) const // Solves found (order keys)
+	{
+		const uint Tail = TailSteps + Roots[0].GetSize() - A.GetSize(); // Steps after the current algorithm
+
+		for (const auto h : ForwardHalves[A.GetSize()])
+		{
+			for (const auto& T : Targets)
+			{
+				const HalfSearchTable& HT = HalfTables[T.Table][h];
+				for (uint e = HT.Find(T.GetKey(S)); e != HalfSearchTable::None; e = HT.GetNext(e))
+				{
+					Stp H[HalfSearchTable::MaxSteps], JoinedStep; // Backward steps (from the canonical orientation for a folded target)
+					for (uint n = 0u; n < h; n++)
+					{
+						H[n] = HalfSearchTable::GetStep(HT.GetSteps(e), n);
+						if (T.Sym != nullptr) H[n] = T.Sym->GetSourceStep(H[n]);
+					}
+
+					if (RelaxedTables[T.Table]) // Backward steps must be canonical (the same check than in the search tree)
+					{
+						bool Canonical = true;
+						for (uint n = 0u; n + 1u < h && Canonical; n++)
+							Canonical = SuccessorSteps::IsCanonical(H[n], H[n + 1u], true) &&
+										(n + 2u >= h || !Algorithm::JoinSteps(H[n], H[n + 1u], H[n + 2u], JoinedStep));
+						if (!Canonical) continue;
+					}
+					if (h > 0u) // The join must be canonical
+					{
+						if (!SuccessorSteps::IsCanonical(A.Last(), H[0], true) || A.ShrinksPenultimate(H[0])) continue;
+						if (h > 1u && Algorithm::JoinSteps(A.Last(), H[0], H[1], JoinedStep)) continue;
+					}
+
+					S64 SolveOrder = Order;
+					for (uint n = 0u; n < h; n++)
+						SolveOrder |= static_cast<S64>(StepsIndex[static_cast<uint>(H[n])] + 1u) << ((Tail - 1u - n) * OrderBits);
+					FSolves.push_back(SolveOrder);
+				}
+			}
+		}
+	}
+
+	// Get the solve algorithm from his order key (bidirectional search)
+	Algorithm DeepSearch::GetJoinSolve(const S64 J) const
+	{
+		const std::vector<Stp>& MainSteps = Levels[0].Unit[0].MainSteps;
+		Algorithm A = Roots[(J >> (TailSteps * OrderBits)) - 1u];
+		for (uint n = TailSteps; n-- > 0u; )
+		{
+			const uint Index = (J >> (n * OrderBits)) & ((1u << OrderBits) - 1u);
+			if (Index == 0u) break;
+			A.Append(MainSteps[Index - 1u]);
+		}
+		return A;
+	}
+
 	// Prepare the branches for the next level of the search
-    inline void DeepSearch::NextLevel(const Algorithm& A, const uint D)
+    inline void DeepSearch::NextLevel(SearchSteps& A, const Cube& C, const uint D, const bool SingleStep)
 	{
 		if (A.GetSize() == 0u || D >= MaxSearchDeep) return;
 		
 		Stp LastStep = A.Last();
+		uint Branches = 0u; // Branch index (depth-first order)
 		for (const auto& U : Levels[D].Unit)
 		{
 			switch (U.Type)
 			{
 			case SequenceType::SINGLE:
-				for (const auto S : U.MainSteps)
+				for (const auto S : (SingleStep ? U.NextMainSteps : U.NextMainStepsSeq).Get(LastStep)) // Only canonical successors of the last step
 				{
-					if (Algorithm::OppositeSteps(LastStep, S) && LastStep > S) continue; // As in an algorithm "... U D ..." branch is the same than "... D U ..." branch, compute only one.
-					Algorithm Alg2 = A; // Continue the search only on a longer algorithm (shorter or equal lenght means that will be calculated upper in the tree)
-					if (!Alg2.AppendShrink(S)) RunSearch(Alg2, D, U.Id); // Recursive
+					if (A.ShrinksPenultimate(S)) continue; // Continue the search only on a longer algorithm (shorter or equal lenght means that will be calculated upper in the tree)
+					Cube C2 = C; // Only the new step is applied to the cube
+					C2.ApplyStep(S);
+					A.Push(S);
+					A.PushBranch(Branches++);
+					Branch(A, C2, D, U.Id); // Recursive
+					A.PopBranch();
+					A.Pop();
 				}
 				break;
 			case SequenceType::CONST:
-                for (const auto& MA : U.MainAlgs)
+                for (uint n = 0u; n < U.MainAlgs.size(); n++)
 				{
-					Algorithm Alg2 = A;
-					Alg2.Append(MA);
-					RunSearch(Alg2, D); // Recursive
+					const Algorithm& MA = U.MainAlgs[n];
+					Cube C2 = C;
+					C2.ApplyEffect(U.GetMainEffect(n, C.GetSpin()));
+					A.Push(MA);
+					A.PushBranch(Branches++);
+					Branch(A, C2, D); // Recursive
+					A.PopBranch();
+					A.Pop(MA.GetSize());
 				}
 				break;
 			case SequenceType::RETURN_FIXED_SINGLE:
 			case SequenceType::RETURN_CONST:
-				for (const auto S : U.AuxSteps)
+				for (const auto S : U.NextAuxSteps.Get(LastStep))
 				{
-					if (Algorithm::OppositeSteps(LastStep, S) && LastStep > S) continue; // As in an algorithm "... U D ..." branch is the same than "... D U ..." branch, compute only one.
-					Algorithm Alg2 = A; // Continue the search only on a longer algorithm (shorter or equal lenght means that will be calculated upper in the tree)
-					if (!Alg2.AppendShrink(S)) RunSearch(Alg2, D, U.Id, 1u); // Recursive
+					if (A.ShrinksPenultimate(S)) continue; // Continue the search only on a longer algorithm (shorter or equal lenght means that will be calculated upper in the tree)
+					Cube C2 = C;
+					C2.ApplyStep(S);
+					A.Push(S);
+					A.PushBranch(Branches++);
+					Branch(A, C2, D, U.Id, 1u); // Recursive
+					A.PopBranch();
+					A.Pop();
 				}
 				break;
 
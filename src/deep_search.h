@@ -23,10 +23,21 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <deque>
 #include <mutex>
 #include <thread>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <chrono>
 
 #include "cube.h"
+#include "pruning.h"
+#include "distance_table.h"
+#include "bidirectional.h"
+#include "thread_pool.h"
+#include "transposition.h"
 
 namespace grcube3
 {
@@ -44,6 +55,41 @@ namespace grcube3
 	// Check or no check the solve in current level
 	enum class SearchCheck { CHECK, NO_CHECK };
 
+	// Range of steps in a successor steps table
+	struct StepsRange
+	{
+		const Stp *First, *Last;
+
+		const Stp* begin() const { return First; }
+		const Stp* end() const { return Last; }
+	};
+
+	// Precomputed table with the canonical next steps (from a steps list) after each possible last step
+	// Redundant successors are removed: steps joined with the last step, opposite layer steps in the wrong order and
+	// optionally all but one order of commuting steps in the same axis (only valid if the last step can be reordered)
+	// The commuting steps order is only sound between consecutive search levels with the same single steps (the
+	// discarded order must be reachable from the previous level), DeepSearch::AddSearchLevel checks it
+	class SuccessorSteps
+	{
+	public:
+		void Update(const std::vector<Stp>&, const bool); // Build the table for the given steps list
+
+		// Get the allowed steps after the given last step
+		StepsRange Get(const Stp Last) const
+		{
+			const uint n = static_cast<uint>(Last);
+			return { Steps.data() + Start[n], Steps.data() + Start[n + 1u] };
+		}
+
+		static bool IsCanonical(const Stp, const Stp, const bool); // Check if a step is a canonical successor of the last step
+
+	private:
+		static constexpr uint StepsAmount = static_cast<uint>(Stp::PARENTHESIS_CLOSE_9_REP) + 1u; // Number of possible last steps
+
+		std::vector<Stp> Steps; // Allowed steps for all last steps
+		std::array<uint, StepsAmount + 1u> Start = {}; // First allowed step for each last step
+	};
+
 	// Struct to store information about unit search sequences
 	struct SearchUnit
 	{
@@ -54,8 +100,13 @@ namespace grcube3
 		
 		std::vector<Stp> MainSteps; // Step for the sequence main part
 		std::vector<Algorithm> MainAlgs; // Algorithms for the sequence main part
+		std::vector<CubeEffect> MainEffects; // Effects of the main part algorithms for each spin (algorithm * 24 + spin)
 		std::vector<Stp> AuxSteps; // Auxiliary steps for the sequence (first and/or last step)	
 
+		SuccessorSteps NextMainSteps, // Canonical main steps after a single step (commuting steps ordered)
+					   NextMainStepsSeq, // Canonical main steps after a sequence or an algorithm
+					   NextAuxSteps; // Canonical auxiliary steps after each last step
+
 		// Constructor with default parameters
 		SearchUnit(const SequenceType _Type,
                    const Sst _MainSteps = Sst::SINGLE_ALL,
@@ -67,9 +118,19 @@ namespace grcube3
 						Algorithm::AddToStepsList(_MainSteps, MainSteps);
 						ClearAlgorithms();
                         Algorithm::AddToStepsList(_AuxSteps, AuxSteps);
+						NextMainSteps.Update(MainSteps, true);
+						NextMainStepsSeq.Update(MainSteps, false);
+						NextAuxSteps.Update(AuxSteps, false);
                    }
-        void AddAlgorithm(const Algorithm &A) { MainAlgs.push_back(A); }
-		void ClearAlgorithms() { MainAlgs.clear(); }
+        void AddAlgorithm(const Algorithm &A)
+		{
+			MainAlgs.push_back(A);
+			for (uint s = 0u; s < 24u; s++) MainEffects.push_back(Cube::GetEffect(A, static_cast<Spn>(s)));
+		}
+		void ClearAlgorithms() { MainAlgs.clear(); MainEffects.clear(); }
+
+		// Effect of the given main part algorithm applied from the given spin
+		const CubeEffect& GetMainEffect(const uint n, const Spn S) const { return MainEffects[n * 24u + static_cast<uint>(S)]; }
 	};
 
 	// Search level data (each search level can have several search units)
@@ -96,6 +157,96 @@ namespace grcube3
 		void Clear() { MaskE = MaskC = 0ull; }
 	};
 
+	// Fixed capacity steps stack for the search algorithms (the search doesn't allocate memory for each node)
+	// Steps are pushed when going down in the search tree and popped when going back
+	class SearchSteps
+	{
+	public:
+		static constexpr uint Capacity = 256u; // Maximum number of steps
+
+		SearchSteps() { Size = 0u; } // Empty steps stack constructor
+		explicit SearchSteps(const Algorithm& A) { Size = 0u; Push(A); } // Constructor from an algorithm
+
+		uint GetSize() const { return Size; } // Get the number of steps in the stack
+
+		Stp Last() const { return Size > 0u ? Steps[Size - 1u] : Stp::NONE; } // Get the last step
+		Stp Penultimate() const { return Size > 1u ? Steps[Size - 2u] : Stp::NONE; } // Get the penultimate step
+		Stp PenultimateInverted() const { return Size > 1u ? Algorithm::InvertedStep(Steps[Size - 2u]) : Stp::NONE; } // Get the inverted penultimate step
+
+		void Push(const Stp S) { Steps[Size++] = S; } // Add a step (no shrink)
+		void Push(const Algorithm& A) { for (uint n = 0u; n < A.GetSize(); n++) Steps[Size++] = A.At(n); } // Add the algorithm steps (no shrink)
+		void Pop(const uint n = 1u) { Size -= n; } // Remove the last steps
+
+		// Returns true if the given step would be joined with the last steps (same check as Algorithm::ShrinkLast)
+		bool Shrinks(const Stp S) const
+		{
+			Stp JoinedStep;
+			return (Size > 0u && Algorithm::JoinSteps(Steps[Size - 1u], S, JoinedStep)) || ShrinksPenultimate(S);
+		}
+
+		// Returns true if the given step would be joined with the penultimate step (through an opposite layer last step)
+		bool ShrinksPenultimate(const Stp S) const
+		{
+			Stp JoinedStep;
+			return Size > 1u && Algorithm::JoinSteps(Steps[Size - 2u], Steps[Size - 1u], S, JoinedStep);
+		}
+
+		// Get the steps as an algorithm
+		Algorithm GetAlgorithm() const { Algorithm A; for (uint n = 0u; n < Size; n++) A.Append(Steps[n]); return A; }
+
+		// Branch path: index of the branch taken in each node from the root (gives the depth-first order of the node)
+		void PushBranch(const uint n) { Path[PathSize++] = n; }
+		void PopBranch() { PathSize--; }
+		std::vector<uint> GetPath() const { return std::vector<uint>(Path.begin(), Path.begin() + PathSize); }
+
+	private:
+		std::array<Stp, Capacity> Steps; // Steps stack
+		uint Size; // Number of steps in the stack
+
+		std::array<uint, Capacity> Path; // Branches path (each node adds at least a step)
+		uint PathSize = 0u; // Number of nodes in the path
+	};
+
+	// Solve found by a search thread, with his position in the search tree
+	struct SearchSolve
+	{
+		std::vector<uint> Path; // Branch path
+		Algorithm Alg; // Solve algorithm
+	};
+
+	// Solve found by a batch search thread (root branch, scramble index and solve algorithm)
+	struct BatchSolve
+	{
+		uint Root, Scramble;
+		Algorithm Alg;
+	};
+
+	// Search task (a branch to be searched by any thread)
+	struct SearchTask
+	{
+		SearchSteps Steps; // Branch algorithm
+		Cube C; // Cube with the scramble and the branch algorithm applied
+		uint Deep, SeqId, SeqSize; // Branch deep and sequence data
+	};
+
+	// Thread data for the search (tasks queue and times)
+	struct SearchWorker
+	{
+		std::deque<SearchTask> Tasks; // Pending tasks for this thread (other threads can steal them)
+		std::mutex TasksMutex; // Mutex for the tasks queue
+		double BusyTime = 0.0, IdleTime = 0.0; // Time searching and time without tasks in the last search (seconds)
+		uint StolenTasks = 0u, SplitTasks = 0u; // Tasks stolen from other threads and subtrees split for other threads
+		S64 Nodes = 0ull; // Search nodes visited by the thread
+		S64 Hits = 0ull, Misses = 0ull; // Transposition table hits and misses in the thread
+		std::vector<SearchSolve> Solves; // Solves found by the thread (merged after the search)
+		std::vector<S64> Joins; // Solves found by the thread in a bidirectional search (as depth-first order keys)
+		std::vector<BatchSolve> BatchSolves; // Solves found by the thread in a batch search
+		std::vector<std::pair<uint, S64>> BatchJoins; // Solves found by the thread in a batch bidirectional search (scramble and order key)
+		std::vector<std::vector<Cube>> BatchCubes; // Cubes alive in each node of the current batch branch (by number of steps)
+		std::vector<std::vector<uint>> BatchIds; // Scramble index for each cube alive
+		std::vector<std::vector<PiecesState>> BatchStates; // Pieces states in each node of the current batch bidirectional branch
+	};
+
     // Class to do a search
 	class DeepSearch
 	{
@@ -111,16 +262,32 @@ namespace grcube3
 		uint GetBranches() const { return RootBranches; } // Get number of root branches in the search
 		uint GetMaxDeep() const { return MaxSearchDeep; } // Get the maximum depth in the search
 		uint GetMinDeep() const { return MinSearchDeep; } // Get the minimum depth in the search
+
+		uint GetThreadsNumber() const { return static_cast<uint>(Workers.size()); } // Get the number of threads used in the last search
+		double GetThreadBusyTime(const uint n) const { return n < Workers.size() ? Workers[n]->BusyTime : 0.0; } // Get thread time searching
+		double GetThreadIdleTime(const uint n) const { return n < Workers.size() ? Workers[n]->IdleTime : 0.0; } // Get thread time without tasks
+		std::string GetThreadsReport() const; // Get the threads busy / idle times report
+
+		S64 GetNodes() const { return Nodes; } // Get the number of nodes visited in the last search
+		double GetSearchTime() const { return SearchTime; } // Get the last search time (seconds)
+		double GetNodesPerSecond() const { return SearchTime > 0.0 ? static_cast<double>(Nodes) / SearchTime : 0.0; } // Get the search speed
 		
-        void SetMinDeep(const uint MinD) { MinSearchDeep = MinD <= MaxSearchDeep ? MinD : MaxSearchDeep; }
+        void SetMinDeep(const uint MinD) { MinSearchDeep = MinD <= MaxSearchDeep ? MinD : MaxSearchDeep.load(); }
 		
         void Run(const int = 0); // Run the search; -1: use no threads, 0: use all threads avaliable, other: use specified number of threads
 
+		// Run the search for a batch of scrambles walking the search tree only once, the solves for each scramble are
+		// stored in his own list (threads parameter as in Run)
+		void RunBatch(const std::vector<Algorithm>&, std::vector<std::vector<Algorithm>>&, const int = 0);
+
+		uint GetBatchSize() const { return BatchSize; } // Get the number of scrambles in the last batch search
+		double GetScramblesPerSecond() const { return SearchTime > 0.0 ? BatchSize / SearchTime : 0.0; } // Get the batch search speed
+
 		// Icrements the deep and return true if the search branch is complete
 		bool IncCheckDeep(uint& Deep)
 		{
 			Deep++;
-			return Deep >= MaxSearchDeep || (MinSearchDeep > 0u && !Solves.empty() && Deep >= MinSearchDeep);
+			return Deep >= MaxSearchDeep || (MinSearchDeep > 0u && SolveFound && Deep >= MinSearchDeep);
 		}
 
         // Returns the shorter algorithm from the solves (optionally priorize some steps)
@@ -162,13 +329,52 @@ namespace grcube3
 		}
 
 		// Add a search level
-		void AddSearchLevel(const SearchLevel& SL) { Levels.push_back(SL); MaxSearchDeep = static_cast<uint>(Levels.size()); }
+		void AddSearchLevel(const SearchLevel&);
 
 		// Reset search levels
 		void ResetSearchLevels() { Levels.clear(); MaxSearchDeep = MinSearchDeep = 0u; }
 
 		bool UpdateRootData(); // Updates root algorithms and sequence data
 
+		// Enable or disable the pruning tables (only used if all search levels are single layer movements)
+		void SetPruning(const bool P) { PruningEnabled = P; }
+
+		// Check if the pruning tables have been used in the last search
+		bool GetPruning() const { return Pruning; }
+
+		// Enable or disable the bidirectional (meet in the middle) search (only used if the pruning tables are used)
+		void SetBidirectional(const bool B) { BidirectionalEnabled = B; }
+
+		// Check if the bidirectional search has been used in the last search
+		bool GetBidirectional() const { return Bidirectional; }
+
+		// Get the maximum number of steps searched backwards from the solved pieces in the last bidirectional search
+		uint GetBackwardSteps() const { return BackwardSteps; }
+
+		// Set a deadline (monotonic clock) for the search: when it is reached the search stops and keeps the solves found so far
+		void SetDeadline(const std::chrono::steady_clock::time_point& D) { Deadline = D; }
+
+		// Set a cancellation token: when other thread sets it the search stops and keeps the solves found so far
+		void SetCancelToken(const std::atomic<bool>* T) { CancelToken = T; }
+
+		// Check if the last search has been truncated by the deadline or the cancellation token
+		bool IsTruncated() const { return Truncated; }
+
+		// Get the deadline for the given time from now in seconds (no deadline if the time is not positive)
+		static std::chrono::steady_clock::time_point GetDeadline(const double Seconds)
+		{
+			if (Seconds <= 0.0) return std::chrono::steady_clock::time_point::max();
+			return std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(Seconds));
+		}
+
+		// Set the transposition table for the search (nullptr = no transposition table), owned by the caller and reused
+		// by its searches. Nodes with the same cube state, depth, last steps and sequence position are searched only once
+		// (some equivalent solves are discarded)
+		void SetTranspositionTable(TranspositionTable* T) { Transpositions = T; }
+
+		S64 GetTranspositionHits() const { return TranspositionHits; } // Nodes not searched again in the last search
+		S64 GetTranspositionMisses() const { return TranspositionMisses; } // Nodes added to the transposition table in the last search
+
 		// Sets a new scramble for the search
         void SetNewScramble(const Algorithm& scr) {	Scramble = scr; CubeBase.Reset(); CubeBase.ApplyAlgorithm(Scramble); }
 
@@ -180,8 +386,8 @@ namespace grcube3
 
 	private:	
 
-		uint MaxSearchDeep, // Maximum deep for the search (levels)
-			 MinSearchDeep; // Minimum deep for the search (if there is at least a solve in MinSearchDeep search deep, stops the search)
+		std::atomic<uint> MaxSearchDeep; // Maximum deep for the search (levels), reduced by any thread with SHORT policy
+		uint MinSearchDeep; // Minimum deep for the search (if there is at least a solve in MinSearchDeep search deep, stops the search)
         Plc SearchPolicy; // Search policy (default best solves)
 		
 		int Cores; // Number of phisical cores in the machine
@@ -199,15 +405,99 @@ namespace grcube3
 
 		std::vector<SearchLevel> Levels; // Levels for search
 
-		std::mutex SearchMutex; // Mutex for multithreading
+		bool PruningEnabled, // Pruning tables requested
+			 Pruning; // Pruning tables used in current search
+		std::vector<const PruningTable*> MandatoryTables; // Pruning tables for mandatory pieces
+		std::vector<std::vector<const PruningTable*>> OptionalTables; // Pruning tables for each optional pieces group
+		std::vector<const DistanceTable*> MandatoryDistanceTables; // Distance tables (from files) for mandatory pieces
+		std::vector<std::vector<const DistanceTable*>> OptionalDistanceTables; // Distance tables for each optional pieces group
+
+		bool BidirectionalEnabled, // Bidirectional search requested
+			 Bidirectional; // Bidirectional search used in current search
+		std::vector<BidirectionalTarget> Targets; // Pieces to solve (mandatory + each optional pieces group)
+		PiecesMoves Moves; // Movements over the pieces state (for the scramble cube spin)
+		PiecesState StartState; // Pieces state with the scramble applied
+		std::vector<std::vector<HalfSearchTable>> HalfTables; // Backward sequences for each canonical target and number of steps
+		std::vector<bool> RelaxedTables; // Backward sequences tables shared by rotated targets (not in canonical steps order)
+		std::vector<std::vector<uint>> ForwardHalves; // Backward steps to join for each forward number of steps
+		uint ForwardSteps, BackwardSteps; // Maximum number of steps searched forwards and backwards
+		std::array<uint, 19u> StepsIndex; // Index of each single layer movement in the search steps (depth-first order)
+		uint TailSteps; // Maximum steps after the root algorithm (each one uses OrderBits in the solves order keys)
+		S64 BackwardNodes; // Backward sequences generated
+
+		static constexpr uint BidirectionalMaxEntries = 1u << 22; // Maximum backward sequences stored
+		static constexpr uint OrderBits = 5u; // Bits for each step index in a solve order key
+
+		std::vector<std::unique_ptr<SearchWorker>> Workers; // Threads data (tasks queues)
+		std::atomic<uint> PendingTasks, // Tasks queued or running
+						  IdleWorkers; // Threads waiting for a task
+		std::atomic<bool> SolveFound; // At least a solve has been found
+
+		std::chrono::steady_clock::time_point Deadline; // Time to stop the search
+		const std::atomic<bool>* CancelToken; // External flag to stop the search
+		std::atomic<bool> Truncated; // The search has been stopped before completion
+		static constexpr S64 StopCheckNodes = 0x3FFull; // Nodes between deadline checks (mask for the thread nodes)
+
+		bool Stopped(); // Check if the search must be stopped (the deadline and the token are checked only every few nodes)
+
+		TranspositionTable* Transpositions; // Search nodes visited (only for nodes not in a sequence)
+		uint TranspositionGeneration; // Transposition table generation for the current search
+		S64 TranspositionHits, TranspositionMisses; // Transposition table hits and misses in the last search
+
+		std::vector<Cube> BatchCubes; // Cubes with the scrambles applied for the current batch search
+		uint BatchSize; // Scrambles in the last batch search
+
+		S64 Nodes; // Nodes visited in the last search
+		double SearchTime; // Last search time (seconds)
+
+		uint GetMaxSteps() const; // Get the maximum number of steps in a search algorithm (from search levels)
+
+		static constexpr uint SplitMinLevels = 2u; // Minimum levels remaining in a subtree to split it for an idle thread
+		
+		void RunThread(const uint); // Search thread: run own tasks and steal tasks from other threads
+
+		bool GetTask(const uint, SearchTask&); // Get a task from the own queue or steal it from other thread
+
+		void Branch(SearchSteps&, const Cube&, const uint, const uint = 0u, const uint = 0u); // Search a branch or split it for an idle thread
+
+        void RunSearch(SearchSteps&, const Cube&, uint, const uint = 0u, uint = 0u); // Run a search branch
+
+		bool Revisited(const SearchSteps&, const Cube&, const uint, const uint, const uint); // Check if a node has been searched before (transposition table)
 		
-		void RunThread(const uint); // Divide search branches into threads
+        void CheckSolve(const SearchSteps&, const Cube&); // Check if an algorithm solves the pieces (algorithm already applied to the cube)
+
+		bool IsSolve(const Cube&) const; // Check if the cube has the search pieces solved
 
-        void RunSearch(const Algorithm&, uint, const uint = 0u, uint = 0u); // Run a search branch
+		void AddSolve(const SearchSteps&); // Add a solve to the current thread solves
 		
-        void CheckSolve(const Algorithm&); // Check if an algorithm solves the pieces
+		bool UpdatePruningData(); // Check if the pruning tables can be used in the search and get them
+
+		// Get the named distance tables from files for pieces inside the given pieces and not inside the excluded pieces
+		static void GetDistanceTables(const MasksPair&, const MasksPair&, std::vector<const DistanceTable*>&, MasksPair&);
+
+		uint GetLowerBound(const Cube&) const; // Get the minimum number of movements needed to solve the pieces
+
+		bool UpdateBidirectionalData(); // Check if the bidirectional search can be used and get the backward sequences
+
+		void RunBidirectional(const int); // Run the bidirectional search
+
+		void RunBidirectionalThread(const uint); // Forward search thread for the bidirectional search
+
+		void ForwardSearch(SearchSteps&, const PiecesState&, const S64, std::vector<S64>&); // Forward search joined with the backward sequences
+
+		void JoinHalves(const SearchSteps&, const PiecesState&, const S64, std::vector<S64>&) const; // Join a forward node with the backward sequences
+
+		Algorithm GetJoinSolve(const S64) const; // Get the solve algorithm from his order key (bidirectional search)
+
+		void RunBatchThread(const uint, const bool); // Batch search thread
+
+		void RunSearchBatch(SearchSteps&, uint, const uint, SearchWorker&); // Search a branch for all scrambles alive (pruning tables)
+
+		void ForwardSearchBatch(SearchSteps&, const S64, SearchWorker&); // Forward search for all scrambles (bidirectional search)
+
+		void MergeSolves(); // Add the solves from all threads in depth-first order
 		
-        void NextLevel(const Algorithm&, const uint); // Prepare the branches for the next level of the search
+        void NextLevel(SearchSteps&, const Cube&, const uint, const bool = false); // Prepare the branches for the next level of the search
 	};
 }
 
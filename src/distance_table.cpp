@@ -0,0 +1,351 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#include <atomic>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+
+#include "distance_table.h"
+#include "thread_pool.h"
+
+namespace grcube3
+{
+	std::vector<std::pair<std::string, std::unique_ptr<DistanceTable>>> DistanceTable::Tables;
+	std::mutex DistanceTable::TablesMutex;
+
+	// Distance table file (.ssmt), all values in the machine byte order: the header and the packed entries
+	// The coordinates are saved as types and pieces (piece index, 0x80 added if the direction is needed, 0xFF for no piece)
+	struct DistanceTableHeader
+	{
+		char Magic[4];
+		std::uint32_t Version, Bits, MaxDistance, CoordinatesNumber;
+		std::uint64_t Entries;
+		std::uint8_t Types[DistanceTable::MaxCoordinates], Pieces[DistanceTable::MaxCoordinates][12];
+		std::uint64_t Checksum;
+	};
+
+	static_assert(sizeof(DistanceTableHeader) % 8u == 0u, "The entries must be aligned");
+
+	static const char TableMagic[4] = { 'S', 'S', 'M', 'T' };
+	static constexpr std::uint32_t TableVersion = 1u;
+
+	// Generate the table with a breadth-first search from the solved state
+	bool DistanceTable::Generate(const std::vector<const Coordinate*>& CList, const uint EntryBits, const int Threads)
+	{
+		if (CList.empty() || CList.size() > MaxCoordinates || (EntryBits != 2u && EntryBits != 4u)) return false;
+
+		S64 Size = 1ull;
+		for (const auto* C : CList) Size *= C->GetSize();
+		if (Size > (1ull << 40)) return false;
+
+		File.Close();
+		Coordinates = CList;
+		for (const auto* C : Coordinates) C->PrepareMoves();
+		Bits = EntryBits;
+		Entries = Size;
+		MaxDistance = 0u;
+		Levels.clear();
+
+		// The frontier is not saved: each level walks all the table in chunks, and the pool threads take the chunks
+		ThreadPool& Pool = ThreadPool::Get();
+		Pool.Start(Threads);
+		const uint Jobs = std::max(1u, Pool.GetThreads());
+		constexpr S64 ChunkSize = 1ull << 16; // Multiple of 4, so the chunks are packed in different bytes
+		const S64 Chunks = (Entries + ChunkSize - 1ull) / ChunkSize;
+
+		auto RunChunks = [&](const std::function<S64(const S64, const S64)>& F)
+		{
+			std::atomic<S64> NextChunk(0ull), Total(0ull);
+			Pool.Run(Jobs, [&](const uint)
+			{
+				for (S64 Chunk = NextChunk++; Chunk < Chunks; Chunk = NextChunk++)
+					Total += F(Chunk * ChunkSize, std::min<S64>(Entries, (Chunk + 1ull) * ChunkSize));
+			});
+			return Total.load();
+		};
+
+		std::unique_ptr<std::atomic<std::uint8_t>[]> Dist(new std::atomic<std::uint8_t>[Entries]);
+		RunChunks([&](const S64 First, const S64 Last)
+		{
+			for (S64 i = First; i < Last; i++) Dist[i].store(static_cast<std::uint8_t>(Unknown), std::memory_order_relaxed);
+			return 0ull;
+		});
+
+		uint Values[MaxCoordinates] = {};
+		for (uint n = 0u; n < Coordinates.size(); n++) Values[n] = Coordinates[n]->GetSolved();
+		Dist[GetIndex(Values)].store(0u);
+		Levels.push_back(1ull);
+
+		S64 Reached = 1ull;
+		for (uint d = 0u; d < Unknown - 1u; d++)
+		{
+			// When the frontier is bigger than the not reached states, the not reached states look for a neighbour in the
+			// frontier (the movements set includes the inverse movements)
+			const bool Backward = Levels[d] > Entries - Reached;
+			const std::uint8_t Current = static_cast<std::uint8_t>(d), Next = static_cast<std::uint8_t>(d + 1u);
+
+			const S64 New = RunChunks([&](const S64 First, const S64 Last)
+			{
+				S64 Count = 0ull;
+				uint V[MaxCoordinates];
+				for (S64 i = First; i < Last; i++)
+				{
+					if (Backward)
+					{
+						if (Dist[i].load(std::memory_order_relaxed) != Unknown) continue;
+						GetValues(i, V);
+						for (uint m = 0u; m < 18u; m++)
+						{
+							if (Dist[GetNeighbor(V, m)].load(std::memory_order_relaxed) != Current) continue;
+							Dist[i].store(Next, std::memory_order_relaxed);
+							Count++;
+							break;
+						}
+					}
+					else
+					{
+						if (Dist[i].load(std::memory_order_relaxed) != Current) continue;
+						GetValues(i, V);
+						for (uint m = 0u; m < 18u; m++)
+						{
+							std::uint8_t Expected = static_cast<std::uint8_t>(Unknown);
+							if (Dist[GetNeighbor(V, m)].compare_exchange_strong(Expected, Next, std::memory_order_relaxed)) Count++;
+						}
+					}
+				}
+				return Count;
+			});
+
+			if (New == 0ull) break;
+			Levels.push_back(New);
+			Reached += New;
+			MaxDistance = d + 1u;
+		}
+
+		// Pack the entries
+		Buffer.assign(GetDataSize(), 0u);
+		RunChunks([&](const S64 First, const S64 Last)
+		{
+			for (S64 i = First; i < Last; i++)
+			{
+				const uint d = Dist[i].load(std::memory_order_relaxed);
+				if (Bits == 4u) Buffer[i >> 1] |= static_cast<std::uint8_t>(std::min(d, 15u) << ((i & 0x1u) << 2));
+				else Buffer[i >> 2] |= static_cast<std::uint8_t>((d == Unknown ? 3u : d % 3u) << ((i & 0x3u) << 1));
+			}
+			return 0ull;
+		});
+
+		Data = Buffer.data();
+		Checksum = GetChecksum(Data, GetDataSize());
+		return true;
+	}
+
+	// Save the table in a file
+	bool DistanceTable::Save(const std::string& Filename) const
+	{
+		if (Data == nullptr) return false;
+
+		DistanceTableHeader H;
+		std::memset(&H, 0, sizeof(H));
+		std::memcpy(H.Magic, TableMagic, sizeof(TableMagic));
+		H.Version = TableVersion;
+		H.Bits = Bits;
+		H.MaxDistance = MaxDistance;
+		H.CoordinatesNumber = static_cast<std::uint32_t>(Coordinates.size());
+		H.Entries = Entries;
+		std::memset(H.Pieces, 0xFF, sizeof(H.Pieces));
+		for (uint n = 0u; n < Coordinates.size(); n++)
+		{
+			H.Types[n] = static_cast<std::uint8_t>(Coordinates[n]->GetType());
+			const auto& Pieces = Coordinates[n]->GetPieces();
+			for (uint p = 0u; p < Pieces.size(); p++)
+				H.Pieces[n][p] = static_cast<std::uint8_t>(Pieces[p].Position | (Pieces[p].Direction ? 0x80u : 0x00u));
+		}
+		H.Checksum = Checksum;
+
+		std::ofstream f(Filename, std::ios::binary | std::ios::trunc);
+		if (!f.is_open()) return false;
+		f.write(reinterpret_cast<const char*>(&H), sizeof(H));
+		f.write(reinterpret_cast<const char*>(Data), static_cast<std::streamsize>(GetDataSize()));
+		return f.good();
+	}
+
+	// Map the table file, returns false if the file is not a valid table
+	bool DistanceTable::Load(const std::string& Filename, const bool Check)
+	{
+		Data = nullptr;
+		Buffer.clear();
+		Coordinates.clear();
+		Levels.clear();
+
+		DistanceTableHeader H;
+		if (!File.Open(Filename) || File.GetSize() < sizeof(H)) { File.Close(); return false; }
+		std::memcpy(&H, File.GetData(), sizeof(H));
+
+		bool Valid = std::memcmp(H.Magic, TableMagic, sizeof(TableMagic)) == 0 && H.Version == TableVersion &&
+					 (H.Bits == 2u || H.Bits == 4u) && H.CoordinatesNumber > 0u && H.CoordinatesNumber <= MaxCoordinates;
+
+		S64 Size = 1ull;
+		for (uint n = 0u; Valid && n < H.CoordinatesNumber; n++)
+		{
+			if (H.Types[n] > static_cast<std::uint8_t>(Crd::CORNERS)) { Valid = false; break; }
+			std::vector<PruningPiece> Pieces;
+			for (uint p = 0u; p < 12u && H.Pieces[n][p] != 0xFFu; p++)
+				Pieces.push_back({ H.Pieces[n][p] & 0x7Fu, (H.Pieces[n][p] & 0x80u) != 0u });
+			Coordinates.push_back(Coordinate::Get(static_cast<Crd>(H.Types[n]), Pieces));
+			Size *= Coordinates.back()->GetSize();
+		}
+
+		Bits = H.Bits;
+		Entries = H.Entries;
+		MaxDistance = H.MaxDistance;
+		Checksum = H.Checksum;
+
+		if (Valid) Valid = Size == Entries && File.GetSize() == sizeof(H) + GetDataSize();
+		if (Valid) Data = File.GetData() + sizeof(H);
+		if (Valid && Check) Valid = GetChecksum(Data, GetDataSize()) == Checksum;
+		if (Valid && Bits == 2u) for (const auto* C : Coordinates) C->PrepareMoves(); // Movements to go down to the solved state
+
+		if (!Valid)
+		{
+			Data = nullptr;
+			Coordinates.clear();
+			File.Close();
+		}
+		return Valid;
+	}
+
+	// Table index for the coordinates values in the given status
+	S64 DistanceTable::GetIndex(const S64 Edges, const S64 Corners) const
+	{
+		uint Values[MaxCoordinates];
+		for (uint n = 0u; n < Coordinates.size(); n++) Values[n] = Coordinates[n]->Get(Edges, Corners);
+		return GetIndex(Values);
+	}
+
+	// Table index for the coordinates values
+	S64 DistanceTable::GetIndex(const uint* Values) const
+	{
+		S64 Index = 0ull;
+		for (uint n = 0u; n < Coordinates.size(); n++) Index = Index * Coordinates[n]->GetSize() + Values[n];
+		return Index;
+	}
+
+	// Coordinates values for an index
+	void DistanceTable::GetValues(S64 Index, uint* Values) const
+	{
+		for (uint n = static_cast<uint>(Coordinates.size()); n-- > 0u; )
+		{
+			Values[n] = static_cast<uint>(Index % Coordinates[n]->GetSize());
+			Index /= Coordinates[n]->GetSize();
+		}
+	}
+
+	// Index after a single layer movement for the coordinates values
+	S64 DistanceTable::GetNeighbor(const uint* Values, const uint m) const
+	{
+		S64 Index = 0ull;
+		for (uint n = 0u; n < Coordinates.size(); n++) Index = Index * Coordinates[n]->GetSize() + Coordinates[n]->Move(Values[n], m);
+		return Index;
+	}
+
+	// Check if the index is the solved state
+	bool DistanceTable::IsSolved(const S64 Index) const
+	{
+		uint Values[MaxCoordinates];
+		GetValues(Index, Values);
+		for (uint n = 0u; n < Coordinates.size(); n++) if (Values[n] != Coordinates[n]->GetSolved()) return false;
+		return true;
+	}
+
+	// Distance for the given index
+	uint DistanceTable::GetDistance(const S64 Index) const
+	{
+		if (Data == nullptr || Index >= Entries) return Unknown;
+		if (Bits == 4u) return GetEntry(Index);
+
+		// Two bits entries: go down to the solved state with the movements that reduce the distance
+		if (GetEntry(Index) == 3u) return Unknown;
+		uint Distance = 0u, Values[MaxCoordinates];
+		for (S64 i = Index; !IsSolved(i); Distance++)
+		{
+			const uint Lower = (GetEntry(i) + 2u) % 3u;
+			GetValues(i, Values);
+			uint m = 0u;
+			while (m < 18u && GetEntry(GetNeighbor(Values, m)) != Lower) m++;
+			if (m == 18u) return Unknown;
+			i = GetNeighbor(Values, m);
+		}
+		return Distance;
+	}
+
+	// FNV-1a checksum of the entries data
+	std::uint64_t DistanceTable::GetChecksum(const std::uint8_t* D, const S64 Size)
+	{
+		std::uint64_t h = 0xCBF29CE484222325ull;
+		for (S64 n = 0ull; n < Size; n++) h = (h ^ D[n]) * 0x100000001B3ull;
+		return h;
+	}
+
+	// Named tables
+	const std::vector<DistanceTableDef>& DistanceTable::GetDefinitions()
+	{
+		static const std::vector<DistanceTableDef> Definitions =
+		{
+			{ "cross", { Pgr::CROSS_D }, false }, // CFOP cross
+			{ "xcross", { Pgr::CROSS_D, Pgr::F2L_D_DFR }, false }, // CFOP cross and first F2L pair
+			{ "roux_fb", { Pgr::UF_B1 }, false }, // Roux first block
+			{ "petrus", { Pgr::PETRUS_DBL }, false }, // Petrus 2x2x2 block
+			{ "eoline", { Pgr::EOLINE_UF }, true } // ZZ EOLine
+		};
+		return Definitions;
+	}
+
+	// Named table definition, nullptr if there is no table with the given name
+	const DistanceTableDef* DistanceTable::GetDefinition(const std::string& Name)
+	{
+		for (const auto& Def : GetDefinitions()) if (Def.Name == Name) return &Def;
+		return nullptr;
+	}
+
+	// Coordinates for a named table
+	void DistanceTable::GetCoordinates(const DistanceTableDef& Def, std::vector<const Coordinate*>& CList)
+	{
+		if (Def.EO) CList.push_back(Coordinate::Get(Crd::EO));
+		Coordinate::GetCoordinates(Def.Groups, CList);
+	}
+
+	// Get a shared named table mapped from his file (loaded only the first time)
+	const DistanceTable* DistanceTable::Get(const std::string& Name)
+	{
+		std::lock_guard<std::mutex> guard(TablesMutex);
+		for (const auto& T : Tables) if (T.first == Name) return T.second.get();
+
+		std::unique_ptr<DistanceTable> T(new DistanceTable);
+		if (!T->Load(GetFilename(Name))) T.reset();
+		Tables.push_back(std::make_pair(Name, std::move(T)));
+		return Tables.back().second.get();
+	}
+}
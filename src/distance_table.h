@@ -0,0 +1,121 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <utility>
+
+#include "coordinates.h"
+#include "mapped_file.h"
+
+namespace grcube3
+{
+	// Named distance table: pieces groups (and all edges oriented if needed) to solve with the single layer movements
+	struct DistanceTableDef
+	{
+		std::string Name; // Table name (and file name without the extension)
+		std::vector<Pgr> Groups; // Pieces groups
+		bool EO; // All edges oriented
+	};
+
+	// Distance table (minimum number of single layer movements) over the product of some coordinates, generated with a
+	// multithreaded breadth-first search and saved in a file with 2 or 4 bits per entry:
+	//  4 bits: the distance (15 for distances over 14 and not reached states)
+	//  2 bits: the distance modulo 3 (3 for not reached states), the distance is found going down to the solved state
+	// The file is mapped in memory when it's loaded, so the table is not generated again in each run
+	class DistanceTable
+	{
+	public:
+		DistanceTable() { }
+
+		DistanceTable(const DistanceTable&) = delete;
+		DistanceTable& operator=(const DistanceTable&) = delete;
+
+		// Generate the table for the given coordinates with the given bits per entry (2 or 4) and threads (0 for a thread
+		// for each core), returns false if the parameters are not valid
+		bool Generate(const std::vector<const Coordinate*>&, const uint = 4u, const int = 0);
+
+		bool Save(const std::string&) const; // Save the table in a file
+		bool Load(const std::string&, const bool = true); // Map the table file (and check the data checksum)
+
+		// Table index for the coordinates values in the given status
+		S64 GetIndex(const S64, const S64) const;
+		S64 GetIndex(const Cube& C) const { return GetIndex(C.GetEdgesStatus(), C.GetCornersStatus()); }
+
+		// Distance for the given index or cube (Unknown if the state is not reached)
+		uint GetDistance(const S64) const;
+		uint GetDistance(const Cube& C) const { return GetDistance(GetIndex(C)); }
+
+		uint GetEntry(const S64 Index) const // Raw entry in the table
+		{
+			return Bits == 4u ? (Data[Index >> 1] >> ((Index & 0x1u) << 2)) & 0xFu : (Data[Index >> 2] >> ((Index & 0x3u) << 1)) & 0x3u;
+		}
+
+		uint GetBits() const { return Bits; }
+		S64 GetEntries() const { return Entries; }
+		uint GetMaxDistance() const { return MaxDistance; }
+		std::uint64_t GetChecksum() const { return Checksum; }
+		const std::vector<const Coordinate*>& GetCoordinates() const { return Coordinates; }
+		const std::vector<S64>& GetLevels() const { return Levels; } // States for each distance (only for generated tables)
+
+		// Named tables (cross, xcross, Roux first block, Petrus 2x2x2 block and ZZ EOLine)
+		static const std::vector<DistanceTableDef>& GetDefinitions();
+		static const DistanceTableDef* GetDefinition(const std::string&);
+		static void GetCoordinates(const DistanceTableDef&, std::vector<const Coordinate*>&);
+		static std::string GetFilename(const std::string& Name) { return Name + ".ssmt"; }
+
+		// Get a shared named table mapped from his file (loaded only the first time), nullptr if the file is not valid
+		static const DistanceTable* Get(const std::string&);
+
+		static constexpr uint MaxCoordinates = 4u; // Maximum coordinates in a table
+		static constexpr uint Unknown = 0xFFu; // Distance for not reached states
+
+	private:
+		std::vector<const Coordinate*> Coordinates; // Table coordinates (the first one is the most significant in the index)
+		uint Bits = 0u, MaxDistance = 0u;
+		S64 Entries = 0ull;
+		std::uint64_t Checksum = 0ull; // FNV-1a checksum of the entries data
+		std::vector<S64> Levels;
+
+		const std::uint8_t* Data = nullptr; // Packed entries
+		std::vector<std::uint8_t> Buffer; // Entries for a generated table
+		MappedFile File; // Entries for a loaded table
+
+		S64 GetDataSize() const { return (Entries * Bits + 7ull) / 8ull; }
+		void GetValues(S64, uint*) const; // Coordinates values for an index
+		S64 GetIndex(const uint*) const; // Index for the coordinates values
+		S64 GetNeighbor(const uint*, const uint) const; // Index after a single layer movement for the coordinates values
+		bool IsSolved(const S64) const; // Check if the index is the solved state
+
+		static std::uint64_t GetChecksum(const std::uint8_t*, const S64);
+
+		// Shared named tables (nullptr for not valid files, so the file is read only once)
+		static std::vector<std::pair<std::string, std::unique_ptr<DistanceTable>>> Tables;
+		static std::mutex TablesMutex; // Mutex for shared tables
+	};
+}
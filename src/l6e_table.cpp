@@ -0,0 +1,295 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#include "l6e_table.h"
+
+namespace grcube3
+{
+	std::unique_ptr<L6ETable> L6ETable::Table;
+	std::mutex L6ETable::TableMutex;
+
+	const Stp L6ETable::Steps[6] = { Stp::U, Stp::Up, Stp::U2, Stp::M, Stp::Mp, Stp::M2 }; // As in Sst::SINGLE_UM
+
+	// Last six edges sticker positions (relative to the spin), the U or D sticker first, and his solved faces
+	static const Asp L6EEdges[6][2] =
+	{
+		{ Asp::UF_U, Asp::UF_F }, { Asp::UB_U, Asp::UB_B }, { Asp::DF_D, Asp::DF_F },
+		{ Asp::DB_D, Asp::DB_B }, { Asp::UL_U, Asp::UL_L }, { Asp::UR_U, Asp::UR_R }
+	};
+	static const Fce L6EFaces[6][2] =
+	{
+		{ Fce::U, Fce::F }, { Fce::U, Fce::B }, { Fce::D, Fce::F },
+		{ Fce::D, Fce::B }, { Fce::U, Fce::L }, { Fce::U, Fce::R }
+	};
+
+	// U layer corners sticker positions around the U layer, the U sticker and the lateral stickers
+	static const Asp L6ECorners[4][3] =
+	{
+		{ Asp::UFR_U, Asp::UFR_F, Asp::UFR_R }, { Asp::UBR_U, Asp::UBR_R, Asp::UBR_B },
+		{ Asp::UBL_U, Asp::UBL_B, Asp::UBL_L }, { Asp::UFL_U, Asp::UFL_L, Asp::UFL_F }
+	};
+	static const Fce LateralFaces[4] = { Fce::F, Fce::R, Fce::B, Fce::L };
+
+	// First blocks sticker positions (relative to the spin) and his solved faces, the DFL corner gives the blocks faces
+	static const Asp BlocksStickers[] =
+	{
+		Asp::FL_F, Asp::FL_L, Asp::BL_B, Asp::BL_L, Asp::DL_D, Asp::DL_L, Asp::DBL_D, Asp::DBL_B, Asp::DBL_L,
+		Asp::FR_F, Asp::FR_R, Asp::BR_B, Asp::BR_R, Asp::DR_D, Asp::DR_R,
+		Asp::DFR_D, Asp::DFR_F, Asp::DFR_R, Asp::DBR_D, Asp::DBR_B, Asp::DBR_R
+	};
+	static const Fce BlocksFaces[] =
+	{
+		Fce::F, Fce::L, Fce::B, Fce::L, Fce::D, Fce::L, Fce::D, Fce::B, Fce::L,
+		Fce::F, Fce::R, Fce::B, Fce::R, Fce::D, Fce::R,
+		Fce::D, Fce::F, Fce::R, Fce::D, Fce::B, Fce::R
+	};
+
+	// Faces relative to the first blocks for each sticker face (opposite faces are consecutive in Fce)
+	static void GetBlocksFaces(const Cube& C, Fce* Faces)
+	{
+		const Spn sp = C.GetSpin();
+		const int D = static_cast<int>(C.GetFace(Cube::FromAbsPosition(Asp::DFL_D, sp))),
+				  F = static_cast<int>(C.GetFace(Cube::FromAbsPosition(Asp::DFL_F, sp))),
+				  L = static_cast<int>(C.GetFace(Cube::FromAbsPosition(Asp::DFL_L, sp)));
+
+		Faces[D] = Fce::D; Faces[D ^ 1] = Fce::U;
+		Faces[F] = Fce::F; Faces[F ^ 1] = Fce::B;
+		Faces[L] = Fce::L; Faces[L ^ 1] = Fce::R;
+	}
+
+	// The edges, the centers and the corners change independently with each movement: the edges movements table is
+	// generated with a cube for each edges state, and the centers and corners are only turned. The distances are
+	// obtained with a breadth-first search from the solved states of each stage (the movements set includes the inverse
+	// movements, so the states graph is not directed)
+	L6ETable::L6ETable()
+	{
+		EdgesMoves.assign(EdgesSize * 6u, 0u);
+		std::vector<bool> Reached(EdgesSize, false);
+		std::vector<Cube> Cubes; // Cube for each reached edges state
+		std::vector<uint> Edges; // Edges state for each cube
+
+		Cubes.push_back(Cube());
+		Edges.push_back(GetIndex(Cubes.front()) >> 4);
+		Reached[Edges.front()] = true;
+		for (uint n = 0u; n < Cubes.size(); n++)
+		{
+			for (uint m = 0u; m < 6u; m++)
+			{
+				Cube C = Cubes[n];
+				C.ApplyStep(Steps[m]);
+				const uint Next = GetIndex(C) >> 4;
+				EdgesMoves[Edges[n] * 6u + m] = static_cast<std::uint16_t>(Next);
+				if (Reached[Next]) continue;
+				Reached[Next] = true;
+				Cubes.push_back(C);
+				Edges.push_back(Next);
+			}
+		}
+
+		for (uint m = 0u; m < 6u; m++)
+		{
+			Cube C;
+			C.ApplyStep(Steps[m]);
+			const uint Index = GetIndex(C);
+			CentersMoves[m] = (Index >> 2) & 0x3u;
+			CornersMoves[m] = Index & 0x3u;
+		}
+
+		// The solved cube gives the reachable states, the other stages are solved only in reachable states
+		std::vector<uint> Level, NextLevel;
+		for (const auto S : { L6e::ALL, L6e::EO, L6e::E2E })
+		{
+			std::vector<std::uint8_t>& D = Distances[static_cast<int>(S)];
+			D.assign(Size, static_cast<std::uint8_t>(Unknown));
+			Level.clear();
+			for (uint Index = 0u; Index < Size; Index += 16u) // Centers and corners solved
+			{
+				if (S != L6e::ALL && Distances[static_cast<int>(L6e::ALL)][Index] == Unknown) continue;
+				if (!IsSolved(Index >> 4, S)) continue;
+				D[Index] = 0u;
+				Level.push_back(Index);
+			}
+
+			uint Distance = 0u, Reachable = static_cast<uint>(Level.size());
+			while (!Level.empty())
+			{
+				NextLevel.clear();
+				for (const auto Index : Level)
+				{
+					for (uint m = 0u; m < 6u; m++)
+					{
+						const uint Next = Move(Index, m);
+						if (D[Next] != Unknown) continue;
+						D[Next] = static_cast<std::uint8_t>(Distance + 1u);
+						NextLevel.push_back(Next);
+					}
+				}
+				if (NextLevel.empty()) break;
+				Reachable += static_cast<uint>(NextLevel.size());
+				Distance++;
+				Level.swap(NextLevel);
+			}
+			MaxDistances[static_cast<int>(S)] = Distance;
+			if (S == L6e::ALL) States = Reachable;
+		}
+	}
+
+	// Distance to the given stage
+	uint L6ETable::GetDistance(const Cube& C, const L6e S) const
+	{
+		if (!AreBlocksSolved(C)) return Unknown;
+		const uint Index = GetIndex(C);
+		return Index == Invalid ? Unknown : Distances[static_cast<int>(S)][Index];
+	}
+
+	// Optimal solve for the given stage
+	bool L6ETable::Solve(const Cube& C, const L6e S, Algorithm& A) const
+	{
+		A.Clear();
+		if (!AreBlocksSolved(C)) return false;
+		const uint Index = GetIndex(C);
+		if (Index == Invalid || Distances[static_cast<int>(S)][Index] == Unknown) return false;
+
+		Algorithm Path;
+		uint BestScore = 0u;
+		Search(Index, Distances[static_cast<int>(S)][Index], Distances[static_cast<int>(S)], Path, A, BestScore);
+		return true;
+	}
+
+	// Search the optimal solves in depth-first order, only the movements that go down a distance level are used
+	void L6ETable::Search(const uint Index, const uint Distance, const std::vector<std::uint8_t>& D,
+						  Algorithm& Path, Algorithm& Best, uint& BestScore) const
+	{
+		if (Distance == 0u)
+		{
+			const uint Score = Path.GetSubjectiveScore();
+			if (Best.GetSize() == 0u || Score > BestScore)
+			{
+				Best = Path;
+				BestScore = Score;
+			}
+			return;
+		}
+
+		for (uint m = 0u; m < 6u; m++)
+		{
+			const uint Next = Move(Index, m);
+			if (D[Next] != Distance - 1u) continue;
+			Path.Append(Steps[m]);
+			Search(Next, Distance - 1u, D, Path, Best, BestScore);
+			Path.EraseLast();
+		}
+	}
+
+	// Check the edges state for a stage: all edges solved (ALL), all edges oriented (EO) or all edges oriented with the
+	// left and right layers edges solved (E2E)
+	bool L6ETable::IsSolved(const uint Edges, const L6e S)
+	{
+		if (Edges & 0x3Fu) return false; // Edges directions
+		const uint Permutation = Edges >> 6;
+		switch (S)
+		{
+		case L6e::ALL: return Permutation == 0u;
+		case L6e::E2E: // M layer edges in the first four positions, then UL & UR
+		{
+			static const uint Factorials[4] = { 120u, 24u, 6u, 2u };
+			uint Used = 0u;
+			for (uint p = 0u; p < 4u; p++)
+			{
+				uint Digit = Permutation / Factorials[p] % (6u - p), e = 0u; // Lehmer code digit
+				while ((Used >> e) & 0x1u || Digit-- > 0u) e++;
+				if (e >= 4u) return false;
+				Used |= 1u << e;
+			}
+			return Permutation % 2u == 0u;
+		}
+		default: return true;
+		}
+	}
+
+	// State index: edges permutation rank and directions, M layer centers and U layer corners turn
+	uint L6ETable::GetIndex(const Cube& C)
+	{
+		Fce Faces[6];
+		GetBlocksFaces(C, Faces);
+		const Spn sp = C.GetSpin();
+		auto GetFace = [&](const Asp A) { return Faces[static_cast<int>(C.GetFace(Cube::FromAbsPosition(A, sp)))]; };
+
+		uint Centers;
+		switch (GetFace(Asp::U))
+		{
+		case Fce::U: Centers = 0u; break;
+		case Fce::B: Centers = 1u; break;
+		case Fce::D: Centers = 2u; break;
+		case Fce::F: Centers = 3u; break;
+		default: return Invalid;
+		}
+
+		uint Turn = 0u;
+		while (Turn < 4u && GetFace(L6ECorners[0][1]) != LateralFaces[Turn]) Turn++;
+		if (Turn == 4u) return Invalid;
+		for (uint n = 0u; n < 4u; n++)
+			if (GetFace(L6ECorners[n][0]) != Fce::U ||
+				GetFace(L6ECorners[n][1]) != LateralFaces[(n + Turn) & 0x3u] ||
+				GetFace(L6ECorners[n][2]) != LateralFaces[(n + Turn + 1u) & 0x3u]) return Invalid;
+
+		uint Used = 0u, Permutation = 0u, Directions = 0u;
+		for (uint p = 0u; p < 6u; p++)
+		{
+			const Fce F0 = GetFace(L6EEdges[p][0]), F1 = GetFace(L6EEdges[p][1]);
+			uint e = 0u;
+			for (; e < 6u; e++)
+			{
+				if (F0 == L6EFaces[e][0] && F1 == L6EFaces[e][1]) break;
+				if (F0 == L6EFaces[e][1] && F1 == L6EFaces[e][0]) { Directions |= 1u << p; break; }
+			}
+			if (e == 6u || (Used >> e) & 0x1u) return Invalid;
+
+			uint Smaller = 0u; // Not used edges before the current one (Lehmer code)
+			for (uint n = 0u; n < e; n++) if (!((Used >> n) & 0x1u)) Smaller++;
+			Permutation = Permutation * (6u - p) + Smaller;
+			Used |= 1u << e;
+		}
+
+		return ((Permutation * 64u + Directions) * 4u + Centers) * 4u + Turn;
+	}
+
+	// Check the first blocks relative to the current spin
+	bool L6ETable::AreBlocksSolved(const Cube& C)
+	{
+		Fce Faces[6];
+		GetBlocksFaces(C, Faces);
+		const Spn sp = C.GetSpin();
+		for (uint n = 0u; n < sizeof(BlocksStickers) / sizeof(Asp); n++)
+			if (Faces[static_cast<int>(C.GetFace(Cube::FromAbsPosition(BlocksStickers[n], sp)))] != BlocksFaces[n]) return false;
+		return true;
+	}
+
+	// Shared tables
+	const L6ETable& L6ETable::Get()
+	{
+		std::lock_guard<std::mutex> guard(TableMutex);
+		if (!Table) Table.reset(new L6ETable);
+		return *Table;
+	}
+}
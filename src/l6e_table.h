@@ -0,0 +1,98 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+
+#include "cube.h"
+#include "algorithm.h"
+
+namespace grcube3
+{
+	// Roux last six edges stages
+	enum class L6e
+	{
+		EO, // Last six edges oriented
+		E2E, // Last six edges oriented and the two edges in the left and right layers solved (UL & UR for the UF spin)
+		ALL // Last six edges solved
+	};
+
+	// Exact distance tables (minimum number of U & M layer movements) for the Roux last six edges stages. The state is
+	// read relative to the first blocks in the current spin (six edges, M layer centers and U layer corners), so the
+	// same tables are valid for all spins. The state space is enumerated the first time the tables are required, and
+	// the solves are read going down through the distances
+	class L6ETable
+	{
+	public:
+		L6ETable(); // Generate the movements tables and the distances
+
+		L6ETable(const L6ETable&) = delete;
+		L6ETable& operator=(const L6ETable&) = delete;
+
+		// Distance to the given stage (Unknown if the cube is not in a last six edges state)
+		uint GetDistance(const Cube&, const L6e) const;
+
+		// Optimal solve for the given stage, between the optimal solves the one with the best subjective score (the first
+		// one in depth-first order for equal scores), returns false if there is no solve
+		bool Solve(const Cube&, const L6e, Algorithm&) const;
+
+		uint GetStates() const { return States; } // Number of reachable states
+		uint GetMaxDistance(const L6e S) const { return MaxDistances[static_cast<int>(S)]; }
+
+		static const L6ETable& Get(); // Shared tables (generated only the first time)
+
+		static constexpr uint Unknown = 0xFFu; // Distance for not reached states
+
+	private:
+		std::vector<std::uint16_t> EdgesMoves; // Edges state after each movement
+		uint CentersMoves[6], CornersMoves[6]; // Centers and corners turns for each movement
+		std::vector<std::uint8_t> Distances[3]; // Distances for each stage by state index
+		uint MaxDistances[3] = { 0u, 0u, 0u };
+		uint States = 0u;
+
+		uint Move(const uint Index, const uint m) const // State index after a movement
+		{
+			return (static_cast<uint>(EdgesMoves[(Index >> 4) * 6u + m]) << 4) |
+				   ((((Index >> 2) + CentersMoves[m]) & 0x3u) << 2) | ((Index + CornersMoves[m]) & 0x3u);
+		}
+
+		// Search the optimal solves from the given state index and distance
+		void Search(const uint, const uint, const std::vector<std::uint8_t>&, Algorithm&, Algorithm&, uint&) const;
+
+		static const Stp Steps[6]; // U & M layer movements (in the search order)
+		static constexpr uint EdgesSize = 720u * 64u; // Edges permutation and directions
+		static constexpr uint Size = EdgesSize * 4u * 4u; // Edges, centers and corners
+		static constexpr uint Invalid = 0xFFFFFFFFu; // Index for a cube out of the last six edges states
+
+		static bool IsSolved(const uint, const L6e); // Check the edges state for a stage (centers and corners solved)
+		static uint GetIndex(const Cube&); // State index (the first blocks are not checked)
+		static bool AreBlocksSolved(const Cube&); // Check the first blocks relative to the current spin
+
+		static std::unique_ptr<L6ETable> Table; // Shared tables
+		static std::mutex TableMutex;
+	};
+}
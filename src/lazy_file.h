@@ -0,0 +1,68 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+namespace grcube3
+{
+	// Data loaded from a file the first time it is required (thread safe)
+	// The constructor is constexpr, so static objects are initialized before any dynamic initialization and can be
+	// used from other static objects
+	template <class T>
+	class LazyFile
+	{
+	public:
+		constexpr LazyFile(const char* f, void (*l)(T&, const std::string&)) : Filename(f), Loader(l) { }
+
+		LazyFile(const LazyFile&) = delete;
+		LazyFile& operator=(const LazyFile&) = delete;
+
+		// Get the data (loaded in the first call)
+		const T& Get() const
+		{
+			std::call_once(Flag, [this]()
+			{
+				Data.reset(new T());
+				Loader(*Data, Filename);
+				Loaded = true;
+			});
+			return *Data;
+		}
+
+		bool IsLoaded() const { return Loaded; } // Check if the data has been loaded
+		const char* GetFilename() const { return Filename; } // Data file name
+
+	private:
+		const char* Filename; // Data file name
+		void (*Loader)(T&, const std::string&); // Function to load the data from the file
+
+		mutable std::once_flag Flag;
+		mutable std::unique_ptr<T> Data;
+		mutable std::atomic<bool> Loaded{ false };
+	};
+}
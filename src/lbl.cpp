@@ -62,6 +62,7 @@ namespace grcube3
 		FLi = static_cast<int>(FLFace); // First layer/face index
 		
 		TimeFLCross = TimeFLCorners = TimeSL = TimeLLCross1 = TimeLLCross2 = TimeLLCorners1 = TimeLLCorners2 = 0.0f;
+		PoolTimeStart = ThreadPool::Get().GetSavedTime();
 		
 		Metric = Metrics::Movements; // Default metric
 	}
@@ -981,6 +982,7 @@ namespace grcube3
         Report += "First layer corners search time: " + std::to_string(GetTimeFLCorners()) + " s\n";
         Report += "Second layer search time: " + std::to_string(GetTimeSL()) + " s\n";
         Report += "Last layer search time: " + std::to_string(GetTimeLL()) + " s\n";
+        Report += "Threads pool time saved: " + std::to_string(ThreadPool::Get().GetSavedTime() - PoolTimeStart) + " s\n";
 
         return Report;
     }
@@ -213,6 +213,7 @@ namespace grcube3
 
         // Times
         double TimeFLCross, TimeFLCorners, TimeSL, TimeLLCross1, TimeLLCross2, TimeLLCorners1, TimeLLCorners2;
+        double PoolTimeStart; // Threads pool saved time when the search was reset
 
 		int Cores; // Cores to use in the search: -1 = no multithreading, 0 = all avaliable cores, other = use this amount of cores
 
@@ -0,0 +1,234 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#include "ll_index.h"
+
+namespace grcube3
+{
+	std::vector<std::unique_ptr<LLIndex>> LLIndex::Indexes;
+	std::mutex LLIndex::IndexesMutex;
+	std::atomic<S64> LLIndex::LookupsCount(0ull), LLIndex::LookupsNanoseconds(0ull);
+
+	// Cube with a given pieces status (to read the stickers of a state source), and access to the cube masks
+	class IndexCube : public Cube
+	{
+	public:
+		IndexCube(const S64 e, const S64 c) { edges = e; corners = c; }
+
+		// Edges and corners masks for the pieces in a layer
+		static void GetLayerMasks(const Lyr Ly, S64& EMask, S64& CMask)
+		{
+			switch (Ly)
+			{
+			case Lyr::U: EMask = EMASK_U; CMask = CMASK_U; break;
+			case Lyr::D: EMask = EMASK_D; CMask = CMASK_D; break;
+			case Lyr::F: EMask = EMASK_F; CMask = CMASK_F; break;
+			case Lyr::B: EMask = EMASK_B; CMask = CMASK_B; break;
+			case Lyr::R: EMask = EMASK_R; CMask = CMASK_R; break;
+			case Lyr::L: EMask = EMASK_L; CMask = CMASK_L; break;
+			case Lyr::E: EMask = EMASK_E; CMask = CMASK_E; break;
+			case Lyr::M: EMask = EMASK_M; CMask = CMASK_M; break;
+			case Lyr::S: EMask = EMASK_S; CMask = CMASK_S; break;
+			default: EMask = CMask = 0ull; break;
+			}
+		}
+
+		static constexpr S64 EMaskData = EMASK_DATA, CMaskData = CMASK_DATA; // Masks for all pieces
+	};
+
+	// Sticker (index in the piece position stickers) with the given face, the stickers number if no sticker has the face
+	static uint GetFaceSticker(const Cube& C, const Sps First, const uint Stickers, const Fce F)
+	{
+		for (uint k = 0u; k < Stickers; k++) if (C.GetFace(static_cast<Sps>(static_cast<uint>(First) + k)) == F) return k;
+		return Stickers;
+	}
+
+	// Get a shared index for the given collection, spin and key type (the index is built only the first time)
+	const LLIndex* LLIndex::Get(const Collection& LLCol, const Spn S, const Type T)
+	{
+		std::lock_guard<std::mutex> guard(IndexesMutex);
+		for (const auto& I : Indexes) if (I->Col == &LLCol && I->Spin == S && I->KeyType == T) return I.get();
+		Indexes.push_back(std::unique_ptr<LLIndex>(new LLIndex(LLCol, S, T)));
+		return Indexes.back().get();
+	}
+
+	// Recognition time per lookup report line for the lookups done since the given statistics (empty if none)
+	std::string LLIndex::GetLookupsReport(const Lookups& Start)
+	{
+		const Lookups Now = GetLookups();
+		if (Now.Count <= Start.Count) return "";
+		const S64 Count = Now.Count - Start.Count;
+		return "Last layer recognition time per lookup: " + std::to_string(1.0e-3 * (Now.Nanoseconds - Start.Nanoseconds) / Count) +
+		       " us (" + std::to_string(Count) + " lookups)\n";
+	}
+
+	// Get the key for the cube state: the status in the key masks, and for the orientation key, the sticker with the up
+	// face in each up layer position (in the free space of the masked status)
+	void LLIndex::GetKey(const Cube& C, S64& E, S64& Cr) const
+	{
+		E = C.GetEdgesStatus() & EMask;
+		Cr = C.GetCornersStatus() & CMask;
+		if (KeyType != Type::ORIENTATION) return;
+		for (uint n = 0u; n < 4u; n++)
+		{
+			const uint e = UpEdges[n], c = UpCorners[n];
+			E |= static_cast<S64>(GetFaceSticker(C, static_cast<Sps>(static_cast<uint>(Sps::FR_F) + 2u * e), 2u, UpFace)) << (4u * e);
+			Cr |= static_cast<S64>(GetFaceSticker(C, static_cast<Sps>(static_cast<uint>(Sps::UFR_U) + 3u * c), 3u, UpFace)) << (8u * c);
+		}
+	}
+
+	// Check if the effect keeps the pieces in the key masks in the key masks positions
+	bool LLIndex::KeepsMasks(const CubeEffect& Ef) const
+	{
+		for (uint p = 0u; p < 12u; p++)
+			if (((EMask >> (4u * p)) & 0xFull) != 0ull && ((EMask >> (4u * (Ef.Edges[p][0] & 0xFu))) & 0xFull) == 0ull) return false;
+		for (uint p = 0u; p < 8u; p++)
+			if (((CMask >> (8u * p)) & 0xFFull) != 0ull && ((CMask >> (8u * (Ef.Corners[p][0] & 0xFu))) & 0xFFull) == 0ull) return false;
+		return true;
+	}
+
+	// Cube state that an effect takes to the solved state: in each position, the piece (and direction) that the effect
+	// moves to his own position with direction 0
+	void LLIndex::GetSolvedSource(const CubeEffect& E, S64& Edges, S64& Corners)
+	{
+		Edges = Corners = 0ull;
+		for (uint p = 0u; p < 12u; p++)
+		{
+			const uint d = (E.Edges[p][0] >> 4) == 0u ? 0u : 1u;
+			Edges |= (static_cast<S64>(E.Edges[p][d] & 0xFu) << (4u * p)) | (static_cast<S64>(d) << (48u + p));
+		}
+		for (uint p = 0u; p < 8u; p++)
+		{
+			uint d = 0u;
+			while ((E.Corners[p][d] >> 4) != 0u) d++;
+			Corners |= (static_cast<S64>(E.Corners[p][d] & 0xFu) | (static_cast<S64>(d) << 4)) << (8u * p);
+		}
+	}
+
+	// Build the index: the cube state solved by each case and movements (the same sequence than in the Cube searchs:
+	// movement before the algorithm, algorithm, turns to recover the spin after the first movement and AUF)
+	LLIndex::LLIndex(const Collection& LLCol, const Spn S, const Type T)
+	{
+		Col = &LLCol;
+		Spin = S;
+		KeyType = T;
+
+		const Lyr UpLayer = Cube::GetUpSliceLayer(S), MidLayer = Cube::AdjacentLayer(UpLayer), DownLayer = Cube::GetDownSliceLayer(S);
+		S64 EM, CM;
+		switch (T)
+		{
+		case Type::ORIENTATION: // First two layers
+			IndexCube::GetLayerMasks(DownLayer, EMask, CMask);
+			IndexCube::GetLayerMasks(MidLayer, EM, CM);
+			EMask |= EM;
+			CMask |= CM;
+			break;
+		case Type::CORNERS: // All corners, middle layer and DR/DL edges
+			IndexCube::GetLayerMasks(MidLayer, EMask, CM);
+			EMask |= Cube::GetMaskSolvedEdge(Cube::PcpToEdp(Cube::FromAbsPosition(App::DR, S))) |
+					 Cube::GetMaskSolvedEdge(Cube::PcpToEdp(Cube::FromAbsPosition(App::DL, S)));
+			CMask = IndexCube::CMaskData;
+			break;
+		default: // Full state
+			EMask = IndexCube::EMaskData;
+			CMask = IndexCube::CMaskData;
+			break;
+		}
+
+		UpFace = Cube::LayerToFace(UpLayer);
+		for (uint p = 0u, e = 0u, c = 0u; p < 12u; p++) // Up layer positions are the positions out of the first two layers masks
+		{
+			if (((EMask >> (4u * p)) & 0xFull) == 0ull && e < 4u) UpEdges[e++] = static_cast<uint8_t>(p);
+			if (p < 8u && ((CMask >> (8u * p)) & 0xFFull) == 0ull && c < 4u) UpCorners[c++] = static_cast<uint8_t>(p);
+		}
+
+		// Movements before the algorithm (y turns or U movements) and after it (AUF)
+		const std::array<Stp, 4u>& BeforeMovs = T == Type::CORNERS ? Algorithm::UMovs : Algorithm::yTurns;
+		const uint AfterMovs = T == Type::ORIENTATION ? 1u : 4u;
+
+		uint TableSize = 16u;
+		while (TableSize < LLCol.GetCasesNumber() * 8u * AfterMovs) TableSize <<= 1; // Load factor <= 0.5
+		Entries.assign(TableSize, Entry{ 0ull, 0ull, None, 0u, 0u });
+		Mask = TableSize - 1u;
+
+		CubeEffect BeforeEffects[4], AfterEffects[4][4]; // Effects for the movements before the algorithm, and AUF effects after each one
+		for (uint b = 0u; b < 4u; b++)
+		{
+			Algorithm BAlg;
+			BAlg.Append(BeforeMovs[b]);
+			BeforeEffects[b] = Cube::GetEffect(BAlg, S);
+			for (uint u = 0u; u < 4u; u++)
+			{
+				Algorithm UAlg;
+				UAlg.Append(Algorithm::UMovs[u]);
+				AfterEffects[b][u] = Cube::GetEffect(UAlg, BeforeEffects[b].End);
+			}
+		}
+
+		std::vector<Entry> CaseEntries;
+		for (uint c = 0u; c < LLCol.GetCasesNumber(); c++)
+		{
+			CaseEntries.clear();
+			bool Keeps = true;
+			for (uint b = 0u; b < 4u && Keeps; b++)
+			{
+				const Spn Spin1 = BeforeEffects[b].End;
+				CubeEffect E = Cube::ComposeEffects(BeforeEffects[b], LLCol.GetEffect(c, Spin1));
+				const Spn Spin2 = E.End;
+				if (Spin1 != Spin2) // Recover the spin after the first movement
+				{
+					Stp StepS1, StepS2;
+					Cube::GetSpinsSteps(Spin2, Spin1, StepS1, StepS2);
+					Algorithm SpinAlg;
+					if (StepS1 != Stp::NONE) SpinAlg.Append(StepS1);
+					if (StepS2 != Stp::NONE) SpinAlg.Append(StepS2);
+					E = Cube::ComposeEffects(E, Cube::GetEffect(SpinAlg, Spin2));
+				}
+
+				for (uint u = 0u; u < AfterMovs && Keeps; u++)
+				{
+					const CubeEffect EU = Cube::ComposeEffects(E, AfterEffects[b][u]);
+					if (T != Type::STATE && (!KeepsMasks(EU) || (T == Type::CORNERS && EU.End != S))) Keeps = false;
+					else
+					{
+						S64 Edges, Corners;
+						GetSolvedSource(EU, Edges, Corners);
+						GetKey(IndexCube(Edges, Corners), Edges, Corners);
+						CaseEntries.push_back(Entry{ Edges, Corners, c, static_cast<uint8_t>(b), static_cast<uint8_t>(u) });
+					}
+				}
+			}
+			if (!Keeps) break; // The next cases can't be indexed with this key
+
+			for (const auto& CE : CaseEntries)
+			{
+				uint i = Hash(CE.Edges, CE.Corners) & Mask;
+				while (Entries[i].Case != None && (Entries[i].Edges != CE.Edges || Entries[i].Corners != CE.Corners)) i = (i + 1u) & Mask;
+				if (Entries[i].Case != None) continue; // The state is solved by a previous combination
+				Entries[i] = CE;
+				Size++;
+			}
+			IndexedCases = c + 1u;
+		}
+	}
+}
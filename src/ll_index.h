@@ -0,0 +1,121 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <string>
+
+#include "cube.h"
+
+namespace grcube3
+{
+	// Last layer recognition index for a collection and a cube spin
+	// For each cube state solved by a case (with a movement before the algorithm and an AUF after it) the index stores
+	// the first case and movements in the search order (cases, movements before, AUF movements), so a lookup gives the
+	// same result than checking all the combinations. Open addressing hash table with the edges and corners status as key
+	// The key can be a projection of the cube state, for the searchs that only check a part of the last layer:
+	//	STATE: full cube state (y turn before the algorithm, AUF after it)
+	//	ORIENTATION: first two layers and the face of the up layer stickers (y turn before the algorithm, no AUF)
+	//	CORNERS: corners, middle layer and DR/DL edges (U movement before the algorithm, AUF after it)
+	// A projection is valid only for algorithms that keep the projected pieces in the projected positions, the index
+	// stops in the first case with an algorithm that moves them (the next cases must be checked without the index)
+	class LLIndex
+	{
+	public:
+		static constexpr uint None = 0xFFFFFFFFu; // No entry
+
+		enum class Type { STATE, ORIENTATION, CORNERS }; // Cube state projection used as key
+
+		struct Entry
+		{
+			S64 Edges, Corners; // Cube state projection (key)
+			uint Case; // Case index in the collection (None for an empty entry)
+			uint8_t Before, After; // Movement before the algorithm and AUF (index in Algorithm::yTurns / Algorithm::UMovs)
+		};
+
+		// Get a shared index for the given collection, spin and key type (the index is built only the first time)
+		static const LLIndex* Get(const Collection&, const Spn, const Type = Type::STATE);
+
+		// Entry for the cube state, nullptr if no indexed case solves the cube
+		const Entry* Find(const Cube& C) const
+		{
+			S64 E, Cr;
+			GetKey(C, E, Cr);
+			for (uint i = Hash(E, Cr) & Mask; Entries[i].Case != None; i = (i + 1u) & Mask)
+				if (Entries[i].Edges == E && Entries[i].Corners == Cr) return &Entries[i];
+			return nullptr;
+		}
+
+		// Recognition lookups statistics (shared by all indexes, the index build is not included)
+		struct Lookups
+		{
+			S64 Count, Nanoseconds; // Number of lookups and total lookup time
+		};
+
+		static void AddLookup(const S64 Nanoseconds) { LookupsCount++; LookupsNanoseconds += Nanoseconds; }
+		static Lookups GetLookups() { return { LookupsCount.load(), LookupsNanoseconds.load() }; }
+
+		// Recognition time per lookup report line for the lookups done since the given statistics (empty if none)
+		static std::string GetLookupsReport(const Lookups&);
+
+		uint GetSize() const { return Size; } // Number of states in the index
+		uint GetIndexedCases() const { return IndexedCases; } // Number of cases in the index (the first cases)
+
+	private:
+		const Collection* Col; // Collection
+		Spn Spin; // Cube spin
+		Type KeyType; // Cube state projection used as key
+		std::vector<Entry> Entries; // Hash table
+		uint Mask = 0u; // Hash table size - 1
+		uint Size = 0u; // Number of states
+		uint IndexedCases = 0u; // Number of cases in the index
+
+		S64 EMask, CMask; // Edges and corners status masks for the key
+		Fce UpFace; // Up layer face (orientation key)
+		uint8_t UpEdges[4], UpCorners[4]; // Up layer edges and corners positions (orientation key)
+
+		LLIndex(const Collection&, const Spn, const Type); // Build the index
+
+		void GetKey(const Cube&, S64&, S64&) const; // Get the key for the cube state
+
+		// Check if the effect keeps the pieces in the key masks in the key masks positions
+		bool KeepsMasks(const CubeEffect&) const;
+
+		static uint Hash(const S64 E, const S64 C)
+		{
+			const S64 h = (E ^ (C * 0xC2B2AE3D27D4EB4Full)) * 0x9E3779B97F4A7C15ull;
+			return static_cast<uint>(h ^ (h >> 32));
+		}
+
+		// Cube state that an effect takes to the solved state
+		static void GetSolvedSource(const CubeEffect&, S64&, S64&);
+
+		static std::vector<std::unique_ptr<LLIndex>> Indexes; // Shared indexes
+		static std::mutex IndexesMutex; // Mutex for shared indexes
+		static std::atomic<S64> LookupsCount, LookupsNanoseconds; // Recognition lookups statistics
+	};
+}
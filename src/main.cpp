@@ -56,11 +56,13 @@ static struct
 		LengthScramble = 20u, // Scramble length
 		NumInsp = 1u, // Number of inspections per orientation
 		Depth1 = 7u, // Primary depth
-		Depth2 = 6u; // Secondary depth
+		Depth2 = 6u, // Secondary depth
+		StageTime = 0u, // Time limit for each search stage in milliseconds (0 = no limit)
+		TranspositionBits = 0u; // Transposition table size for the searches (2 ^ bits slots, 0 = no transposition table)
 
 	int Threads = 0; // Number of threads to use in the search (0 = all cores, -1 = no threads)
 
-	bool Best = false, Debug = false, Regrip = false, Cancellations = false, OneLookL6E = false, Times = false;
+	bool Best = false, Debug = false, Regrip = false, Cancellations = false, OneLookL6E = false, Times = false, Batch = false, Compile = false;
 } Parameters;
 
 void ProcessParameters(int, char* []); // Process command line parameters
@@ -73,7 +75,7 @@ void ProcessOrientations(std::vector<Lyr>&, const Orientations);
 void ProcessOrientations(std::vector<Spn>&, const Orientations);
 
 void sLBL(const Algorithm&, std::ofstream&);
-void sCFOP(const Algorithm&, std::ofstream&);
+void sCFOP(const Algorithm&, std::ofstream&, const std::vector<Algorithm>* = nullptr, const double = 0.0);
 void sRoux(const Algorithm&, std::ofstream&);
 void sPetrus(const Algorithm&, std::ofstream&);
 void sZZ(const Algorithm&, std::ofstream&);
@@ -89,6 +91,18 @@ int main(int argc, char* argv[])
 	// Process command line parameters
 	ProcessParameters(argc, argv);
 
+	if (Parameters.Compile) // Convert the XML files to compiled files (loaded at start instead of the XML files)
+	{
+		for (const auto AS : { AlgSets::OLL, AlgSets::PLL, AlgSets::_1LLL, AlgSets::ZBLL, AlgSets::OCLL, AlgSets::CMLL, AlgSets::COLL, AlgSets::EPLL })
+		{
+			const std::string F = Cube::GetAlgorithmsFile(AS);
+			std::cout << "Compiling " << F << " to " << Collection::GetCompiledFilename(F) << "... " << (Collection::CompileXMLCollectionFile(F) ? "Done!" : "Error!") << std::endl;
+		}
+		for (const auto& F : { "cancel2.xml", "cancel3.xml" })
+			std::cout << "Compiling " << F << " to " << Collection::GetCompiledFilename(F) << "... " << (Algorithm::CompileXMLCancellationsFile(F) ? "Done!" : "Error!") << std::endl;
+		return 0;
+	}
+
 	std::cout << GetParametersSummary();
 
 	if (Parameters.Method == Methods::NONE)
@@ -138,10 +152,22 @@ int main(int argc, char* argv[])
 	ctime_s(currenttime, 100, &start_time);
 	f_log << "----------------------------------------\n" << argv[0] << " executed at " << currenttime << "\n";
 #endif
-	f_log << GetExternalFilesCheck();
-	f_log << "\n";
 	f_log << GetParametersSummary();
 	f_log << "\n";
+	ThreadPool::Get().Start(Parameters.Threads); // Search threads are started once for all solves
+
+	// CFOP crosses for all scrambles in a single search (the search tree is walked only once)
+	std::vector<std::vector<Algorithm>> BatchCrosses;
+	double BatchCrossesTime = 0.0; // Crosses search time per scramble
+	if (Parameters.Batch && Parameters.Method == Methods::CFOP)
+	{
+		std::cout << "Searching CFOP crosses for " << Scrambles.size() << " scrambles... " << std::flush;
+		const double ScramblesPerSecond = CFOP::SearchCrossesBatch(Scrambles, Parameters.Depth1, BatchCrosses, Parameters.Threads);
+		if (ScramblesPerSecond > 0.0) BatchCrossesTime = 1.0 / ScramblesPerSecond;
+		std::cout << "Done! (" << ScramblesPerSecond << " scrambles/s)" << std::endl;
+		f_log << "Crosses batch search: " << Scrambles.size() << " scrambles, " << ScramblesPerSecond << " scrambles/s\n\n";
+	}
+
 	// Main loop
 	uint n = 0u;
 	for (const auto& Scramble : Scrambles)
@@ -151,7 +177,7 @@ int main(int argc, char* argv[])
 		switch (Parameters.Method)
 		{
 		case Methods::LBL: sLBL(Scramble, f_log); break;
-		case Methods::CFOP: sCFOP(Scramble, f_log); break;
+		case Methods::CFOP: sCFOP(Scramble, f_log, BatchCrosses.empty() ? nullptr : &BatchCrosses[n - 1u], BatchCrossesTime); break;
 		case Methods::ROUX: sRoux(Scramble, f_log); break;
 		case Methods::PETRUS: sPetrus(Scramble, f_log); break;
 		case Methods::ZZ: sZZ(Scramble, f_log); break;
@@ -159,6 +185,9 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	f_log << GetExternalFilesCheck(); // After the solves, when the files needed by the method have been loaded
+	f_log << "\n";
+
 	f_log.close();
 }
 
@@ -172,6 +201,13 @@ void ProcessParameters(int argc, char* argv[])
 	{
 		std::string Par = argv[p], SubPar;
 
+		if (Par.find("COMPILE") != std::string::npos || Par.find("compile") != std::string::npos || Par.find("Compile") != std::string::npos)
+		{
+			Parameters.Compile = true;
+			std::cout << "Compile XML files (parameter '" << Par << "')" << std::endl;
+			continue;
+		}
+
 		if (Par.find("LBL") != std::string::npos || Par.find("lbl") != std::string::npos || Par.find("Lbl") != std::string::npos)
 		{
 			Parameters.Method = Methods::LBL;
@@ -361,6 +397,13 @@ void ProcessParameters(int argc, char* argv[])
 			continue;
 		}
 
+		if (Par.find("BATCH") != std::string::npos || Par.find("batch") != std::string::npos || Par.find("Batch") != std::string::npos)
+		{
+			Parameters.Batch = true;
+			std::cout << "Batch search enabled (parameter '" << Par << "')" << std::endl;
+			continue;
+		}
+
 		if (Par.find("DEBUG") != std::string::npos || Par.find("debug") != std::string::npos || Par.find("Debug") != std::string::npos)
 		{
 			Parameters.Debug = true;
@@ -426,6 +469,22 @@ void ProcessParameters(int argc, char* argv[])
 			std::cout << "Secondary depth set to " << Parameters.Depth2 << " (parameter '" << Par << "')" << std::endl;
 			break;
 
+		case 'b': case 'B':// Time limit for each search stage
+			SubPar = Par.substr(2);
+			Parameters.StageTime = std::stoi(SubPar);
+			if (Parameters.StageTime > 3600000u) Parameters.StageTime = 3600000u;
+			if (Parameters.StageTime == 0u) std::cout << "No time limit for the search stages (parameter '" << Par << "')" << std::endl;
+			else std::cout << "Time limit for each search stage set to " << Parameters.StageTime << " ms (parameter '" << Par << "')" << std::endl;
+			break;
+
+		case 'h': case 'H': // Transposition table size
+			SubPar = Par.substr(2);
+			Parameters.TranspositionBits = std::stoi(SubPar);
+			if (Parameters.TranspositionBits > 28u) Parameters.TranspositionBits = 28u;
+			if (Parameters.TranspositionBits == 0u) std::cout << "No transposition table (parameter '" << Par << "')" << std::endl;
+			else std::cout << "Transposition table size set to 2^" << Parameters.TranspositionBits << " nodes (parameter '" << Par << "')" << std::endl;
+			break;
+
 		case 'o': case 'O': // Orientations to search
 			SubPar = Par.substr(2);
 			if (SubPar.length() < 1u) std::cout << "Unknown orientation '" << Par << "'" << std::endl;
@@ -681,7 +740,7 @@ void sLBL(const Algorithm& Scramble, std::ofstream& flog)
 	std::cout << "Done!" << "\n\n" << Report << std::endl;
 }
 
-void sCFOP(const Algorithm& Scramble, std::ofstream& flog)
+void sCFOP(const Algorithm& Scramble, std::ofstream& flog, const std::vector<Algorithm>* BatchCrosses, const double BatchTime)
 {
 	CFOP SearchCFOP(Scramble, Parameters.Threads);
 
@@ -689,12 +748,28 @@ void sCFOP(const Algorithm& Scramble, std::ofstream& flog)
 	ProcessOrientations(CrossLayers, Parameters.Orient);
 	SearchCFOP.SetCrossLayers(CrossLayers);
 	SearchCFOP.SetMetric(Parameters.Metric);
+	SearchCFOP.SetTimeLimit(Parameters.StageTime / 1000.0);
+	SearchCFOP.SetTranspositionTable(Parameters.TranspositionBits);
 
-	std::cout << "Searching CFOP crosses... " << std::flush;
+	bool CrossesFound;
+	if (BatchCrosses != nullptr) // Crosses already searched in the batch search
+	{
+		std::cout << "Evaluating CFOP crosses... " << std::flush;
+		SearchCFOP.SetDepthCrosses(Parameters.Depth1);
+		SearchCFOP.EvaluateCrosses(*BatchCrosses, Parameters.NumInsp);
+		SearchCFOP.SetTimeCrosses(BatchTime);
+		CrossesFound = !BatchCrosses->empty();
+	}
+	else
+	{
+		std::cout << "Searching CFOP crosses... " << std::flush;
+		CrossesFound = SearchCFOP.SearchCrosses(Parameters.Depth1, Parameters.NumInsp);
+	}
 
-	if (!SearchCFOP.SearchCrosses(Parameters.Depth1, Parameters.NumInsp))
+	if (!CrossesFound)
 	{
 		std::cout << "\n" << "No CFOP crosses found!" << std::endl;
+		if (SearchCFOP.IsTruncated()) std::cout << "Some searches were truncated by the time limit" << std::endl;
 		return;
 	}
 
@@ -732,6 +807,7 @@ void sCFOP(const Algorithm& Scramble, std::ofstream& flog)
 	if (Parameters.Best) std::cout << "\nBest solve - " << SearchCFOP.GetBestReport(Parameters.Cancellations) << std::endl;
 
 	if (Parameters.Times) std::cout << SearchCFOP.GetTimeReport() << std::endl;
+	else if (SearchCFOP.IsTruncated()) std::cout << "Some searches were truncated by the time limit\n" << std::endl;
 }
 
 void sRoux(const Algorithm& Scramble, std::ofstream& flog)
@@ -745,11 +821,14 @@ void sRoux(const Algorithm& Scramble, std::ofstream& flog)
 	SearchRoux.SetSearchSpins(SearchSpins);
 
 	SearchRoux.SetMetric(Parameters.Metric);
+	SearchRoux.SetTimeLimit(Parameters.StageTime / 1000.0);
+	SearchRoux.SetTranspositionTable(Parameters.TranspositionBits);
 
 	std::cout << "Searching Roux first blocks... " << std::flush;
 	if (!SearchRoux.SearchFirstBlock(Parameters.Depth1, Parameters.NumInsp))
 	{
 		std::cout << "\n" << "No Roux first blocks found!" << std::endl;
+		if (SearchRoux.IsTruncated()) std::cout << "Some searches were truncated by the time limit" << std::endl;
 		return;
 	}
 
@@ -771,10 +850,10 @@ void sRoux(const Algorithm& Scramble, std::ofstream& flog)
 	std::cout << "L6E... " << std::flush;
 	if (!Parameters.OneLookL6E)
 	{
-		SearchRoux.SearchL6EO(10u);
-		SearchRoux.SearchL6E2E(12u);
+		SearchRoux.SearchL6EO();
+		SearchRoux.SearchL6E2E();
 	}
-	SearchRoux.SearchL6E(15u);
+	SearchRoux.SearchL6E();
 
 	if (Parameters.Regrip) SearchRoux.SetRegrips();
 
@@ -787,6 +866,7 @@ void sRoux(const Algorithm& Scramble, std::ofstream& flog)
 	if (Parameters.Best) std::cout << "\nBest solve - " << SearchRoux.GetBestReport(Parameters.Cancellations) << std::endl;
 
 	if (Parameters.Times) std::cout << SearchRoux.GetTimeReport() << std::endl;
+	else if (SearchRoux.IsTruncated()) std::cout << "Some searches were truncated by the time limit\n" << std::endl;
 }
 
 void sPetrus(const Algorithm& Scramble, std::ofstream& flog)
@@ -800,11 +880,14 @@ void sPetrus(const Algorithm& Scramble, std::ofstream& flog)
 	SearchPetrus.SetSearchSpins(SearchSpins);
 
 	SearchPetrus.SetMetric(Parameters.Metric);
+	SearchPetrus.SetTimeLimit(Parameters.StageTime / 1000.0);
+	SearchPetrus.SetTranspositionTable(Parameters.TranspositionBits);
 
 	std::cout << "Searching Petrus blocks... " << std::flush;
 	if (!SearchPetrus.SearchBlock(Parameters.Depth1, Parameters.NumInsp))
 	{
 		std::cout << "\n" << "No Petrus blocks!" << std::endl;
+		if (SearchPetrus.IsTruncated()) std::cout << "Some searches were truncated by the time limit" << std::endl;
 		return;
 	}
 
@@ -850,6 +933,7 @@ void sPetrus(const Algorithm& Scramble, std::ofstream& flog)
 	if (Parameters.Best) std::cout << "\nBest solve - " << SearchPetrus.GetBestReport(Parameters.Cancellations) << std::endl;
 
 	if (Parameters.Times) std::cout << SearchPetrus.GetTimeReport() << std::endl;
+	else if (SearchPetrus.IsTruncated()) std::cout << "Some searches were truncated by the time limit\n" << std::endl;
 }
 
 void sZZ(const Algorithm& Scramble, std::ofstream& flog)
@@ -863,11 +947,14 @@ void sZZ(const Algorithm& Scramble, std::ofstream& flog)
 	SearchZZ.SetSearchSpins(SearchSpins);
 
 	SearchZZ.SetMetric(Parameters.Metric);
+	SearchZZ.SetTimeLimit(Parameters.StageTime / 1000.0);
+	SearchZZ.SetTranspositionTable(Parameters.TranspositionBits);
 
 	std::cout << "Searching EOX... " << std::flush;
 	if (!SearchZZ.SearchEOX(Parameters.Depth1, Parameters.NumInsp))
 	{
 		std::cout << "\n" << "No EO Lines found!" << std::endl;
+		if (SearchZZ.IsTruncated()) std::cout << "Some searches were truncated by the time limit" << std::endl;
 		return;
 	}
 
@@ -907,6 +994,7 @@ void sZZ(const Algorithm& Scramble, std::ofstream& flog)
 	if (Parameters.Best) std::cout << "\nBest solve - " << SearchZZ.GetBestReport(Parameters.Cancellations) << std::endl;
 
 	if (Parameters.Times) std::cout << SearchZZ.GetTimeReport() << std::endl;
+	else if (SearchZZ.IsTruncated()) std::cout << "Some searches were truncated by the time limit\n" << std::endl;
 }
 
 std::string GetParametersSummary()
@@ -935,9 +1023,12 @@ std::string GetParametersSummary()
 		else if (Parameters.Collect == Collections::ZBLL) oss << "\tLast layer in two looks: EO + ZBLL\n";
 		else oss << "\tInvalid algset for CFOP, using OLL + PLL instead\n";
 		oss << "\tSearch depth: " << Parameters.Depth1 << "\n";
+		if (Parameters.Batch) oss << "\tCrosses will be searched for all scrambles in a single batch search\n";
 		if (Parameters.Best) oss << "\tBest solve will be shown\n";
 		if (Parameters.Regrip) oss << "\tRegrips will be added\n";
 		if (Parameters.Cancellations) oss << "\tCancellations will be applied\n";
+		if (Parameters.StageTime > 0u) oss << "\tTime limit for each search stage: " << Parameters.StageTime << " ms\n";
+		if (Parameters.TranspositionBits > 0u) oss << "\tTransposition table: 2^" << Parameters.TranspositionBits << " nodes\n";
 		if (Parameters.Times) oss << "\tSearch times will be shown\n";
 		oss << "\tCores: " << (Parameters.Threads == 0 ? "All\n" : std::to_string(Parameters.Threads)) << std::flush;
 		break;
@@ -958,6 +1049,8 @@ std::string GetParametersSummary()
 		if (Parameters.Best) oss << "\tBest solve will be shown\n";
 		if (Parameters.Regrip) oss << "\tRegrips will be added\n";
 		if (Parameters.Cancellations) oss << "\tCancellations will be applied\n";
+		if (Parameters.StageTime > 0u) oss << "\tTime limit for each search stage: " << Parameters.StageTime << " ms\n";
+		if (Parameters.TranspositionBits > 0u) oss << "\tTransposition table: 2^" << Parameters.TranspositionBits << " nodes\n";
 		if (Parameters.Times) oss << "\tSearch times will be shown\n";
 		oss << "\tCores: " << (Parameters.Threads == 0 ? "All\n" : std::to_string(Parameters.Threads)) << std::flush;
 		break;
@@ -977,6 +1070,8 @@ std::string GetParametersSummary()
 		if (Parameters.Best) oss << "\tBest solve will be shown\n";
 		if (Parameters.Regrip) oss << "\tRegrips will be added\n";
 		if (Parameters.Cancellations) oss << "\tCancellations will be applied\n";
+		if (Parameters.StageTime > 0u) oss << "\tTime limit for each search stage: " << Parameters.StageTime << " ms\n";
+		if (Parameters.TranspositionBits > 0u) oss << "\tTransposition table: 2^" << Parameters.TranspositionBits << " nodes\n";
 		if (Parameters.Times) oss << "\tSearch times will be shown\n";
 		oss << "\tCores: " << (Parameters.Threads == 0 ? "All\n" : std::to_string(Parameters.Threads)) << std::flush;
 		break;
@@ -995,6 +1090,8 @@ std::string GetParametersSummary()
 		if (Parameters.Best) oss << "\tBest solve will be shown\n";
 		if (Parameters.Regrip) oss << "\tRegrips will be added\n";
 		if (Parameters.Cancellations) oss << "\tCancellations will be applied\n";
+		if (Parameters.StageTime > 0u) oss << "\tTime limit for each search stage: " << Parameters.StageTime << " ms\n";
+		if (Parameters.TranspositionBits > 0u) oss << "\tTransposition table: 2^" << Parameters.TranspositionBits << " nodes\n";
 		if (Parameters.Times) oss << "\tSearch times will be shown\n";
 		oss << "\tCores: " << (Parameters.Threads == 0 ? "All\n" : std::to_string(Parameters.Threads)) << std::flush;
 		break;
@@ -1010,16 +1107,22 @@ std::string GetExternalFilesCheck()
 {
 	std::ostringstream oss;
 
-	oss << "Number of 3-movements cancellations loaded: " << std::to_string(Algorithm::GetCancellation3Size() >> 1) << "\n";
-	oss << "Number of 2-movements cancellations loaded: " << std::to_string(Algorithm::GetCancellation2Size() >> 1) << "\n";
-	oss << "OLL algorithms loaded: " << std::to_string(Cube::OLL_Algorithms.GetCasesNumber()) << "\n";
-	oss << "PLL algorithms loaded: " << std::to_string(Cube::PLL_Algorithms.GetCasesNumber()) << "\n";
-	oss << "1LLL algorithms loaded: " << std::to_string(Cube::Algorithms_1LLL.GetCasesNumber()) << "\n";
-	oss << "ZBLL algorithms loaded: " << std::to_string(Cube::ZBLL_Algorithms.GetCasesNumber()) << "\n";
-	oss << "COLL algorithms loaded: " << std::to_string(Cube::COLL_Algorithms.GetCasesNumber()) << "\n";
-	oss << "EPLL algorithms loaded: " << std::to_string(Cube::EPLL_Algorithms.GetCasesNumber()) << "\n";
-	oss << "OCLL algorithms loaded: " << std::to_string(Cube::OCLL_Algorithms.GetCasesNumber()) << "\n";
-	oss << "CMLL algorithms loaded: " << std::to_string(Cube::CMLL_Algorithms.GetCasesNumber()) << "\n";
+	// Cancellations and algorithms collections are loaded when a method needs them
+	if (Algorithm::AreCancellationsLoaded())
+	{
+		oss << "Number of 3-movements cancellations loaded: " << std::to_string(Algorithm::GetCancellation3Size() >> 1) << "\n";
+		oss << "Number of 2-movements cancellations loaded: " << std::to_string(Algorithm::GetCancellation2Size() >> 1) << "\n";
+	}
+	else oss << "Cancellations not loaded\n";
+
+	const std::pair<AlgSets, std::string> AlgSetsNames[] = { { AlgSets::OLL, "OLL" }, { AlgSets::PLL, "PLL" }, { AlgSets::_1LLL, "1LLL" },
+		{ AlgSets::ZBLL, "ZBLL" }, { AlgSets::COLL, "COLL" }, { AlgSets::EPLL, "EPLL" }, { AlgSets::OCLL, "OCLL" }, { AlgSets::CMLL, "CMLL" } };
+
+	for (const auto& AN : AlgSetsNames)
+	{
+		if (Cube::IsLoaded(AN.first)) oss << AN.second << " algorithms loaded: " << std::to_string(Cube::GetAlgorithms(AN.first).GetCasesNumber()) << "\n";
+		else oss << AN.second << " algorithms not loaded\n";
+	}
 
 	return oss.str();
 }
@@ -0,0 +1,94 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#include <fstream>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "mapped_file.h"
+
+namespace grcube3
+{
+	// Map the given file, returns false if the file can't be read or is empty
+	bool MappedFile::Open(const std::string& Filename)
+	{
+		Close();
+
+#ifdef __linux__
+		const int fd = open(Filename.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size <= 0)
+		{
+			close(fd);
+			return false;
+		}
+
+		void* p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd); // The mapping keeps his own reference to the file
+		if (p == MAP_FAILED) return false;
+
+		Data = static_cast<const std::uint8_t*>(p);
+		Size = static_cast<std::size_t>(st.st_size);
+		Mapped = true;
+		return true;
+#else
+		std::ifstream f(Filename, std::ios::binary | std::ios::ate);
+		if (!f.is_open()) return false;
+
+		const std::streamoff FileSize = f.tellg();
+		if (FileSize <= 0) return false;
+
+		Buffer.resize(static_cast<std::size_t>(FileSize));
+		f.seekg(0);
+		if (!f.read(reinterpret_cast<char*>(Buffer.data()), FileSize))
+		{
+			Buffer.clear();
+			return false;
+		}
+
+		Data = Buffer.data();
+		Size = Buffer.size();
+		return true;
+#endif
+	}
+
+	// Release the file
+	void MappedFile::Close()
+	{
+#ifdef __linux__
+		if (Mapped) munmap(const_cast<std::uint8_t*>(Data), Size);
+#endif
+		Data = nullptr;
+		Size = 0u;
+		Mapped = false;
+		Buffer.clear();
+		Buffer.shrink_to_fit();
+	}
+}
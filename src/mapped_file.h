@@ -0,0 +1,56 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace grcube3
+{
+	// Read only file mapped in memory (in systems without memory mapped files the whole file is read in a buffer)
+	class MappedFile
+	{
+	public:
+		MappedFile() { }
+		~MappedFile() { Close(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::string&); // Map the given file, returns false if the file can't be read or is empty
+		void Close(); // Release the file
+
+		bool IsOpen() const { return Data != nullptr; }
+		const std::uint8_t* GetData() const { return Data; } // File contents
+		std::size_t GetSize() const { return Size; } // File size in bytes
+
+	private:
+		const std::uint8_t* Data = nullptr; // File contents
+		std::size_t Size = 0u; // File size
+		bool Mapped = false; // The file contents are mapped (not in the buffer)
+		std::vector<std::uint8_t> Buffer; // File contents if the file is not mapped
+	};
+}
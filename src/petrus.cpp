@@ -22,6 +22,7 @@
 
 #include "petrus.h"
 #include "cfop.h"
+#include "cube_batch.h"
 
 #include <chrono>
 #include <algorithm>
@@ -53,6 +54,12 @@ namespace grcube3
 		
         MaxDepthBlock = MaxDepthF2L = 0u;
         TimeBlock = TimeExpBlock = TimeEO = TimeF2L = TimeZBLL = TimeOCLL = TimePLL = TimeCOLL = TimeEPLL = 0.0;
+        PoolTimeStart = ThreadPool::Get().GetSavedTime();
+        LookupsStart = LLIndex::GetLookups();
+        TimeLimit = 0.0;
+        Transpositions.Resize(0u);
+        Truncated = false;
+        ThreadsBlock.clear();
 		
 		Metric = Metrics::Movements; // Default metric
 	}
@@ -61,6 +68,7 @@ namespace grcube3
     // Return false if no block found
     bool Petrus::SearchBlock(const uint MaxDepth, const uint MaxSolves)
 	{
+        StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
         const auto time_block_start = std::chrono::system_clock::now();
 
         MaxDepthBlock = (MaxDepth <= 4u ? 4u : MaxDepth);
@@ -92,11 +100,17 @@ namespace grcube3
         for (uint l = 2u; l < MaxDepthBlock; l++) DSBlock.AddSearchLevel(L_Check);
 
         DSBlock.UpdateRootData();
+        DSBlock.SetPruning(true); // Use pruning tables for the pieces to solve
+        DSBlock.SetBidirectional(true); // Meet in the middle search (forwards from the scramble, backwards from the solved pieces)
 		// DSFB.SetMinDeep(DSFB.GetMaxDeep() - 2u);
 
+        DSBlock.SetDeadline(StageDeadline);
+        DSBlock.SetTranspositionTable(&Transpositions);
         DSBlock.Run(Cores);
+        if (DSBlock.IsTruncated()) Truncated = true;
 
         Cores = DSBlock.GetCoresUsed(); // Update to the real number of cores used
+        ThreadsBlock = DSBlock.GetThreadsReport();
 
         EvaluateBlock(DSBlock.Solves, MaxSolves);
 
@@ -137,6 +151,7 @@ namespace grcube3
     // Search the best expanded block solve algorithm
     void Petrus::SearchExpandedBlock()
     {
+        StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
         const auto time_eb_start = std::chrono::system_clock::now();
 
 		const SearchUnit U_Root(SequenceType::DOUBLE, Sst::PETRUS_EB);
@@ -211,7 +226,10 @@ namespace grcube3
 
 				DSEB.UpdateRootData();
 
+				DSEB.SetDeadline(StageDeadline);
+				DSEB.SetTranspositionTable(&Transpositions);
 				DSEB.Run(Cores);
+				if (DSEB.IsTruncated()) Truncated = true;
 				
 				Cores = DSEB.GetCoresUsed(); // Update to the real number of cores used
 
@@ -234,6 +252,7 @@ namespace grcube3
     // Orientate the other edges outside the block
     void Petrus::SearchEO()
     {
+        StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
         const auto time_EO_start = std::chrono::system_clock::now();
         
 		const SearchUnit U_UR(SequenceType::SINGLE, Sst::SINGLE_UR);
@@ -309,7 +328,10 @@ namespace grcube3
 
 				DSEO.UpdateRootData();
 
+				DSEO.SetDeadline(StageDeadline);
+				DSEO.SetTranspositionTable(&Transpositions);
 				DSEO.Run(Cores);
+				if (DSEO.IsTruncated()) Truncated = true;
 
 				std::vector<Algorithm> Solves;
 				CFOP::EvaluateF2LResult(Solves, 1u, DSEO.Solves, CubePetrus, Cube::GetDownSliceLayer(spin), Plc::BEST_SOLVES);
@@ -331,6 +353,7 @@ namespace grcube3
 	// Complete the two first layers (F2L)
     void Petrus::SearchF2L(const uint MaxDepth)
 	{
+		StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
 		const auto time_F2L_start = std::chrono::system_clock::now();
 
 		MaxDepthF2L = (MaxDepth <= 4u ? 4u : MaxDepth);
@@ -390,7 +413,10 @@ namespace grcube3
 
 				DSF2L.UpdateRootData();
 
+				DSF2L.SetDeadline(StageDeadline);
+				DSF2L.SetTranspositionTable(&Transpositions);
 				DSF2L.Run(Cores);
+				if (DSF2L.IsTruncated()) Truncated = true;
 
 				F2L[sp].push_back(Algorithm(""));
 				DSF2L.EvaluateShortestResult(F2L[sp][n], true);
@@ -404,6 +430,7 @@ namespace grcube3
 	// Complete the two first layers (F2L) - Alternative version (don't use it, slower and debug needed)
 	void Petrus::SearchF2L_Alt(const uint MaxDepth)
 	{
+		StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
 		const auto time_F2L_start = std::chrono::system_clock::now();
 
 		MaxDepthF2L = (MaxDepth <= 4u ? 4u : MaxDepth);
@@ -596,7 +623,10 @@ namespace grcube3
 					if (F2L_Pair_2_IsSolved) DS_F2L.AddToMandatoryPieces(F2L_Pair_2);
 					else DS_F2L.AddToOptionalPieces(F2L_Pair_2);
 
+					DS_F2L.SetDeadline(StageDeadline);
+					DS_F2L.SetTranspositionTable(&Transpositions);
 					DS_F2L.Run(Cores);
+					if (DS_F2L.IsTruncated()) Truncated = true;
 
 					DS_F2L.EvaluateShortestResult(F2L_Aux, true);
 
@@ -889,43 +919,45 @@ namespace grcube3
 	}
 
 	// Check if Petrus block is built for given spin
-	bool Petrus::IsBlockBuilt(const Cube& C, const Spn sp)
+	bool Petrus::IsBlockBuilt(const Cube& C, const Spn sp) { return C.IsSolved(GetBlock(sp)); }
+
+	// Petrus block pieces group for given spin
+	Pgr Petrus::GetBlock(const Spn sp)
 	{
 		switch (sp)
 		{
 		case Spn::UF:
 		case Spn::FR:
-		case Spn::RU:	return C.IsSolved(Pgr::PETRUS_DBL);
+		case Spn::RU:	return Pgr::PETRUS_DBL;
 		
 		case Spn::UB:
 		case Spn::BL:
-		case Spn::LU: return C.IsSolved(Pgr::PETRUS_DFR);
+		case Spn::LU: return Pgr::PETRUS_DFR;
 		
 		case Spn::UR: 
 		case Spn::BU:
-		case Spn::RB: return C.IsSolved(Pgr::PETRUS_DFL);
+		case Spn::RB: return Pgr::PETRUS_DFL;
 		
 		case Spn::UL:
 		case Spn::FU:
-		case Spn::LF: return C.IsSolved(Pgr::PETRUS_DBR);
+		case Spn::LF: return Pgr::PETRUS_DBR;
 
 		case Spn::DF:
 		case Spn::FL:
-		case Spn::LD: return C.IsSolved(Pgr::PETRUS_UBR);
+		case Spn::LD: return Pgr::PETRUS_UBR;
 		
 		case Spn::DB:
 		case Spn::BR:
-		case Spn::RD: return C.IsSolved(Pgr::PETRUS_UFL);
+		case Spn::RD: return Pgr::PETRUS_UFL;
 		
 		case Spn::DR: 
 		case Spn::FD:
-		case Spn::RF: return C.IsSolved(Pgr::PETRUS_UBL);
+		case Spn::RF: return Pgr::PETRUS_UBL;
 		
 		case Spn::DL:
 		case Spn::BD:
-		case Spn::LB: return C.IsSolved(Pgr::PETRUS_UFR);
-
-		default: return false; // Should not happend
+		case Spn::LB: 
+		default: return Pgr::PETRUS_UFR;
 		}
 	}
 
@@ -969,41 +1001,43 @@ namespace grcube3
 	}
 
 	// Check if Petrus expanded block is built for given spin
-	bool Petrus::IsExpandedBlockBuilt(const Cube& C, const Spn spin)
+	bool Petrus::IsExpandedBlockBuilt(const Cube& C, const Spn spin) { return C.IsSolved(GetExpandedBlock(spin)); }
+
+	// Petrus expanded block pieces group for given spin
+	Pgr Petrus::GetExpandedBlock(const Spn spin)
 	{
 		switch (spin)
 		{
-		case Spn::UF: return C.IsSolved(Pgr::PETRUS_DBL_Z);
-		case Spn::UB: return C.IsSolved(Pgr::PETRUS_DFR_Z);
-		case Spn::UR: return C.IsSolved(Pgr::PETRUS_DFL_X);
-		case Spn::UL: return C.IsSolved(Pgr::PETRUS_DBR_X);
-
-		case Spn::DF: return C.IsSolved(Pgr::PETRUS_UBR_Z);
-		case Spn::DB: return C.IsSolved(Pgr::PETRUS_UFL_Z);
-		case Spn::DR: return C.IsSolved(Pgr::PETRUS_UBL_X);
-		case Spn::DL: return C.IsSolved(Pgr::PETRUS_UFR_X);
-
-		case Spn::FU: return C.IsSolved(Pgr::PETRUS_DBR_Y);
-		case Spn::FD: return C.IsSolved(Pgr::PETRUS_UBL_Y);
-		case Spn::FR: return C.IsSolved(Pgr::PETRUS_DBL_X);
-		case Spn::FL: return C.IsSolved(Pgr::PETRUS_UBR_X);
-
-		case Spn::BU: return C.IsSolved(Pgr::PETRUS_DFL_Y);
-		case Spn::BD: return C.IsSolved(Pgr::PETRUS_UFR_Y);
-		case Spn::BR: return C.IsSolved(Pgr::PETRUS_UFL_X);
-		case Spn::BL: return C.IsSolved(Pgr::PETRUS_DFR_X);
-
-		case Spn::RU: return C.IsSolved(Pgr::PETRUS_DBL_Y);
-		case Spn::RD: return C.IsSolved(Pgr::PETRUS_UFL_Y);
-		case Spn::RF: return C.IsSolved(Pgr::PETRUS_UBL_Z);
-		case Spn::RB: return C.IsSolved(Pgr::PETRUS_DFL_Z);
-
-		case Spn::LU: return C.IsSolved(Pgr::PETRUS_DFR_Y);
-		case Spn::LD: return C.IsSolved(Pgr::PETRUS_UBR_Y);
-		case Spn::LF: return C.IsSolved(Pgr::PETRUS_DBR_Z);
-		case Spn::LB: return C.IsSolved(Pgr::PETRUS_UFR_Z);
-
-		default: return false; // Should not happend
+		case Spn::UF: return Pgr::PETRUS_DBL_Z;
+		case Spn::UB: return Pgr::PETRUS_DFR_Z;
+		case Spn::UR: return Pgr::PETRUS_DFL_X;
+		case Spn::UL: return Pgr::PETRUS_DBR_X;
+
+		case Spn::DF: return Pgr::PETRUS_UBR_Z;
+		case Spn::DB: return Pgr::PETRUS_UFL_Z;
+		case Spn::DR: return Pgr::PETRUS_UBL_X;
+		case Spn::DL: return Pgr::PETRUS_UFR_X;
+
+		case Spn::FU: return Pgr::PETRUS_DBR_Y;
+		case Spn::FD: return Pgr::PETRUS_UBL_Y;
+		case Spn::FR: return Pgr::PETRUS_DBL_X;
+		case Spn::FL: return Pgr::PETRUS_UBR_X;
+
+		case Spn::BU: return Pgr::PETRUS_DFL_Y;
+		case Spn::BD: return Pgr::PETRUS_UFR_Y;
+		case Spn::BR: return Pgr::PETRUS_UFL_X;
+		case Spn::BL: return Pgr::PETRUS_DFR_X;
+
+		case Spn::RU: return Pgr::PETRUS_DBL_Y;
+		case Spn::RD: return Pgr::PETRUS_UFL_Y;
+		case Spn::RF: return Pgr::PETRUS_UBL_Z;
+		case Spn::RB: return Pgr::PETRUS_DFL_Z;
+
+		case Spn::LU: return Pgr::PETRUS_DFR_Y;
+		case Spn::LD: return Pgr::PETRUS_UBR_Y;
+		case Spn::LF: return Pgr::PETRUS_DBR_Z;
+		case Spn::LB: 
+		default: return Pgr::PETRUS_UFR_Z;
 		}
 	}
 	
@@ -1033,19 +1067,32 @@ namespace grcube3
 
 		std::vector<std::pair<uint, Algorithm>> ScoredSolves;
 
-		for (const auto& s : Solves)
+		// The solves are applied in batches, with the block checks done for all the cubes in the batch
+		const LanesMask BlockMask(GetBlock(spin)), ExpandedBlockMask(GetExpandedBlock(spin));
+		CubeBatch Batch;
+		uint BlockSolved = 0u, ExpandedBlockSolved = 0u;
+
+		for (uint i = 0u; i < Solves.size(); i++)
 		{
+			const uint b = i % CubeBatch::MaxSize; // Solve position in the batch
+			if (b == 0u) // Next batch
+			{
+				const uint Valid = Batch.SetAlgorithms(CBase, Solves, i);
+				for (uint n = 0u; n < Batch.GetSize(); n++) // Algorithms not valid in byte lanes are applied with a cube
+					if (((Valid >> n) & 1u) == 0u) Batch.SetAlgorithm(n, CBase, Solves[i + n]);
+				BlockSolved = Batch.IsSolved(BlockMask);
+				ExpandedBlockSolved = Batch.IsSolved(ExpandedBlockMask);
+			}
+
+			const Algorithm& s = Solves[i];
 			Score = 0u;
 
-			Cube CheckCube = CBase;
-            CheckCube.ApplyAlgorithm(s);
-			
-			if (!IsBlockBuilt(CheckCube, spin)) continue;
+			if (((BlockSolved >> b) & 1u) == 0u) continue;
 
 			Score += (s.GetSize() > 50u ? 0u : 50u - s.GetSize()) * SolveSizeMagnitude;
 			Score += s.GetSubjectiveScore();
 			
-			if (IsExpandedBlockBuilt(CheckCube, spin)) Score += SolveExpandedBlockMagnitude;
+			if ((ExpandedBlockSolved >> b) & 1u) Score += SolveExpandedBlockMagnitude;
 			
 			if (Score > 0u)
 			{
@@ -1216,8 +1263,14 @@ namespace grcube3
         Report += "Edges orientation search time: " + std::to_string(GetTimeEO()) + " s\n";
         Report += "F2L search time: " + std::to_string(GetTimeF2L()) + " s\n";
         Report += "Last layer search time: " + std::to_string(GetTimeLL()) + " s\n";
+
+        Report += LLIndex::GetLookupsReport(LookupsStart);
+
         Report += "Threads used: " + std::to_string(GetUsedCores() > 0 ? GetUsedCores() : 0) +
                   " of " + std::to_string(DeepSearch::GetSystemCores()) + "\n";
+        Report += "Threads pool time saved: " + std::to_string(ThreadPool::Get().GetSavedTime() - PoolTimeStart) + " s\n";
+        if (IsTruncated()) Report += "Some searches were truncated by the time limit\n";
+        if (!ThreadsBlock.empty()) Report += "Blocks search threads:\n" + ThreadsBlock;
 
         return Report;
     }
@@ -24,6 +24,7 @@
 
 #include "cube_definitions.h"
 #include "deep_search.h"
+#include "ll_index.h"
 
 namespace grcube3
 {
@@ -57,6 +58,15 @@ namespace grcube3
 		// Set the metric for evaluations
 		void SetMetric(const Metrics m) { Metric = m; }
 
+		// Set the time limit for each search stage in seconds (0 = no limit), a stage out of time keeps the solves found so far
+		void SetTimeLimit(const double t) { TimeLimit = t; }
+
+		// Set the transposition table size for the searches (2 ^ given bits slots, 0 = no transposition table)
+		void SetTranspositionTable(const uint b) { Transpositions.Resize(b); }
+
+		// Check if any search stage has been truncated by the time limit
+		bool IsTruncated() const { return Truncated; }
+
         // Search the best block solve algorithm with the given search depth
         // Return false if no block found
         bool SearchBlock(const uint, const uint = 1u);
@@ -179,6 +189,10 @@ namespace grcube3
         // Check if Petrus expanded block is built for given spin
         static bool IsExpandedBlockBuilt(const Cube&, const Spn);
 
+        // Petrus block and expanded block pieces groups for given spin
+        static Pgr GetBlock(const Spn);
+        static Pgr GetExpandedBlock(const Spn);
+
         // Returns best block solves from the Solves vector class member for the given corner position block (Petrus)
         static bool EvaluateBlockResult(std::vector<Algorithm>&, const uint, const std::vector<Algorithm>&, const Cube&, const Spn, const Plc);
 		
@@ -217,6 +231,13 @@ namespace grcube3
 
 		// Times
         double TimeBlock, TimeExpBlock, TimeEO, TimeF2L, TimeZBLL, TimeOCLL, TimePLL, TimeCOLL, TimeEPLL;
+        double PoolTimeStart; // Threads pool saved time when the search was reset
+        LLIndex::Lookups LookupsStart; // Last layer recognition lookups when the search was reset
+        double TimeLimit; // Time limit for each search stage (seconds)
+        TranspositionTable Transpositions; // Transposition table reused by all the searches
+        std::chrono::steady_clock::time_point StageDeadline; // Deadline for the current search stage
+        bool Truncated; // Some search stage has been truncated by the time limit
+        std::string ThreadsBlock; // Threads busy / idle times report for the blocks search
 
         // Check if the solves for the given spin are consistent (all needed algorithms are present)
         bool CheckSolveConsistency(const Spn) const;
@@ -0,0 +1,209 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+#include "pruning.h"
+
+namespace grcube3
+{
+	uint8_t PruningTable::EdgesMovs[18][24];
+	uint8_t PruningTable::CornersMovs[18][24];
+	std::once_flag PruningTable::MovsFlag;
+	std::vector<std::unique_ptr<PruningTable>> PruningTable::Tables;
+	std::mutex PruningTable::TablesMutex;
+
+	// Auxiliary class to access the edges and corners movements
+	class PruningPieces : public c_Edges, public c_Corners
+	{
+	public:
+		void SetEdges(const S64 e) { edges = e; }
+		void SetCorners(const S64 c) { corners = c; }
+		S64 GetEdges() const { return edges; }
+		S64 GetCorners() const { return corners; }
+
+		// Apply a single layer movement (0 to 17, same order than in Stp enumeration)
+		void Move(const uint m)
+		{
+			switch (m)
+			{
+			case 0u: e_U(); c_U(); break;
+			case 1u: e_Up(); c_Up(); break;
+			case 2u: e_U2(); c_U2(); break;
+			case 3u: e_D(); c_D(); break;
+			case 4u: e_Dp(); c_Dp(); break;
+			case 5u: e_D2(); c_D2(); break;
+			case 6u: e_F(); c_F(); break;
+			case 7u: e_Fp(); c_Fp(); break;
+			case 8u: e_F2(); c_F2(); break;
+			case 9u: e_B(); c_B(); break;
+			case 10u: e_Bp(); c_Bp(); break;
+			case 11u: e_B2(); c_B2(); break;
+			case 12u: e_R(); c_R(); break;
+			case 13u: e_Rp(); c_Rp(); break;
+			case 14u: e_R2(); c_R2(); break;
+			case 15u: e_L(); c_L(); break;
+			case 16u: e_Lp(); c_Lp(); break;
+			case 17u: e_L2(); c_L2(); break;
+			default: break;
+			}
+		}
+
+		static constexpr S64 EdgesSolved = EMASK_SOLVED;
+		static constexpr S64 CornersSolved = CMASK_SOLVED;
+	};
+
+	// Movements tables initialization: where goes a piece in a given slot for each movement
+	void PruningTable::InitMovs()
+	{
+		PruningPieces PP;
+		uint8_t EdgesSlots[12], CornersSlots[8];
+
+		for (uint m = 0u; m < 18u; m++)
+		{
+			for (uint p = 0u; p < 12u; p++) // Edges
+			{
+				for (uint d = 0u; d < 2u; d++)
+				{
+					PP.SetEdges(PruningPieces::EdgesSolved | (static_cast<S64>(d) << (48u + p)));
+					PP.Move(m);
+					GetEdgesSlots(PP.GetEdges(), EdgesSlots);
+					EdgesMovs[m][p * 2u + d] = EdgesSlots[p];
+				}
+			}
+			for (uint p = 0u; p < 8u; p++) // Corners
+			{
+				for (uint d = 0u; d < 3u; d++)
+				{
+					PP.SetCorners(PruningPieces::CornersSolved | (static_cast<S64>(d) << (8u * p + 4u)));
+					PP.Move(m);
+					GetCornersSlots(PP.GetCorners(), CornersSlots);
+					CornersMovs[m][p * 3u + d] = CornersSlots[p];
+				}
+			}
+		}
+	}
+
+	// Fill the edges slots (position * 2 + direction) for each edge from edges status
+	void PruningTable::GetEdgesSlots(const S64 Edges, uint8_t* Slots)
+	{
+		for (uint p = 0u; p < 12u; p++)
+			Slots[(Edges >> (4u * p)) & 0xFu] = static_cast<uint8_t>(p * 2u + ((Edges >> (48u + p)) & 0x1u));
+	}
+
+	// Fill the corners slots (position * 3 + direction) for each corner from corners status
+	void PruningTable::GetCornersSlots(const S64 Corners, uint8_t* Slots)
+	{
+		for (uint p = 0u; p < 8u; p++)
+			Slots[(Corners >> (8u * p)) & 0x7u] = static_cast<uint8_t>(p * 3u + ((Corners >> (8u * p + 4u)) & 0x3u));
+	}
+
+	// Pruning table constructor
+	PruningTable::PruningTable(const Pct PType, const std::vector<PruningPiece>& PList)
+	{
+		std::call_once(MovsFlag, InitMovs);
+
+		Type = PType;
+		Pieces = PList;
+		MaxDistance = 0u;
+
+		const uint NDirs = Type == Pct::EDGE ? 2u : 3u;
+		const uint NPieces = static_cast<uint>(Pieces.size());
+		const auto& Movs = Type == Pct::EDGE ? EdgesMovs : CornersMovs;
+
+		uint Size = 1u;
+		for (uint n = 0u; n < NPieces; n++) Size *= 24u;
+		Distances.assign(Size, Unknown);
+
+		std::vector<uint> Current, Next; // Breadth-first search frontiers
+
+		// Solved states (when direction is not needed, all directions are solved)
+		Current.push_back(0u);
+		for (uint n = NPieces; n-- > 0u; )
+		{
+			const PruningPiece& P = Pieces[n];
+			for (auto& I : Current) I *= 24u;
+			std::vector<uint> Aux;
+			for (const auto I : Current)
+			{
+				Aux.push_back(I + P.Position * NDirs);
+				if (!P.Direction) for (uint d = 1u; d < NDirs; d++) Aux.push_back(I + P.Position * NDirs + d);
+			}
+			Current = Aux;
+		}
+		for (const auto I : Current) Distances[I] = 0u;
+
+		uint8_t Slots[MaxPieces];
+		while (!Current.empty())
+		{
+			Next.clear();
+			for (const auto I : Current)
+			{
+				uint Aux = I;
+				for (uint n = 0u; n < NPieces; n++) { Slots[n] = static_cast<uint8_t>(Aux % 24u); Aux /= 24u; }
+
+				for (uint m = 0u; m < 18u; m++)
+				{
+					uint NewIndex = 0u;
+					for (uint n = NPieces; n-- > 0u; ) NewIndex = NewIndex * 24u + Movs[m][Slots[n]];
+					if (Distances[NewIndex] == Unknown)
+					{
+						Distances[NewIndex] = static_cast<uint8_t>(MaxDistance + 1u);
+						Next.push_back(NewIndex);
+					}
+				}
+			}
+			if (!Next.empty()) MaxDistance++;
+			Current.swap(Next);
+		}
+	}
+
+	// Get a shared pruning table for the given pieces (the table is generated only the first time)
+	const PruningTable* PruningTable::Get(const Pct PType, const std::vector<PruningPiece>& PList)
+	{
+		std::lock_guard<std::mutex> guard(TablesMutex);
+		for (const auto& T : Tables) if (T->Type == PType && T->Pieces == PList) return T.get();
+		Tables.push_back(std::unique_ptr<PruningTable>(new PruningTable(PType, PList)));
+		return Tables.back().get();
+	}
+
+	// Get the pruning tables needed to check the given edges and corners solve masks
+	// Only pieces with full position in the mask are used (a lower bound for the masks)
+	void PruningTable::GetTables(const S64 MaskE, const S64 MaskC, std::vector<const PruningTable*>& TList)
+	{
+		std::vector<PruningPiece> PList;
+
+		for (uint p = 0u; p < 12u; p++) // Edges
+		{
+			if (((MaskE >> (4u * p)) & 0xFu) != 0xFu) continue;
+			PList.push_back({ p, ((MaskE >> (48u + p)) & 0x1u) != 0u });
+			if (PList.size() == MaxPieces) { TList.push_back(Get(Pct::EDGE, PList)); PList.clear(); }
+		}
+		if (!PList.empty()) { TList.push_back(Get(Pct::EDGE, PList)); PList.clear(); }
+
+		for (uint p = 0u; p < 8u; p++) // Corners
+		{
+			if (((MaskC >> (8u * p)) & 0x7u) != 0x7u) continue;
+			PList.push_back({ p, ((MaskC >> (8u * p + 4u)) & 0x3u) != 0u });
+			if (PList.size() == MaxPieces) { TList.push_back(Get(Pct::CORNER, PList)); PList.clear(); }
+		}
+		if (!PList.empty()) TList.push_back(Get(Pct::CORNER, PList));
+	}
+}
@@ -0,0 +1,100 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <memory>
+
+#include "cube_definitions.h"
+#include "edges.h"
+#include "corners.h"
+
+namespace grcube3
+{
+	// Piece tracked by a pruning table (solved position index and if the direction must be solved)
+	struct PruningPiece
+	{
+		uint Position; // Piece (and solved position) index: 0 to 11 for edges, 0 to 7 for corners
+		bool Direction; // Direction must be solved
+
+		bool operator==(const PruningPiece& rhp) const { return Position == rhp.Position && Direction == rhp.Direction; }
+	};
+
+	// Distance table (minimum number of single layer movements) for a small group of edges or corners
+	// Each tracked piece is coded as position * directions + direction (24 values both for edges and corners)
+	class PruningTable
+	{
+	public:
+		// Pruning table constructor (generates the table with a breadth-first search from the solved pieces)
+		PruningTable(const Pct, const std::vector<PruningPiece>&);
+
+		// Get the distance for the given pieces slots (position * directions + direction for each cube piece)
+		uint GetDistance(const uint8_t* Slots) const
+		{
+			uint Index = 0u;
+			for (auto P = Pieces.rbegin(); P != Pieces.rend(); P++) Index = Index * 24u + Slots[P->Position];
+			return Distances[Index];
+		}
+
+		// Get the pieces type of the table (edges or corners)
+		Pct GetType() const { return Type; }
+
+		// Get the tracked pieces
+		const std::vector<PruningPiece>& GetPieces() const { return Pieces; }
+
+		// Get the maximum distance in the table
+		uint GetMaxDistance() const { return MaxDistance; }
+
+		// Get a shared pruning table for the given pieces (the table is generated only the first time)
+		static const PruningTable* Get(const Pct, const std::vector<PruningPiece>&);
+
+		// Get the pruning tables needed to check the given edges and corners solve masks
+		static void GetTables(const S64, const S64, std::vector<const PruningTable*>&);
+
+		// Fill the pieces slots (position * directions + direction) from edges and corners status
+		static void GetEdgesSlots(const S64, uint8_t*);
+		static void GetCornersSlots(const S64, uint8_t*);
+
+		// Get the new slot for each slot after a single layer movement (0 to 17, same order than in Stp enumeration, default spin)
+		static const uint8_t* GetEdgesMovs(const uint m) { std::call_once(MovsFlag, InitMovs); return EdgesMovs[m]; }
+		static const uint8_t* GetCornersMovs(const uint m) { std::call_once(MovsFlag, InitMovs); return CornersMovs[m]; }
+
+		static constexpr uint MaxPieces = 4u; // Maximum pieces tracked in a single table
+		static constexpr uint8_t Unknown = 0xFFu; // Distance not reached
+
+	private:
+		Pct Type; // Edges or corners
+		std::vector<PruningPiece> Pieces; // Tracked pieces
+		std::vector<uint8_t> Distances; // Distances table
+		uint MaxDistance; // Maximum distance in the table
+
+		// Movements tables for a single piece slot (18 single layer movements x 24 slots)
+		static uint8_t EdgesMovs[18][24], CornersMovs[18][24];
+		static std::once_flag MovsFlag; // Movements tables initialization flag
+		static void InitMovs(); // Movements tables initialization
+
+		static std::vector<std::unique_ptr<PruningTable>> Tables; // Shared tables
+		static std::mutex TablesMutex; // Mutex for shared tables
+	};
+}
@@ -22,6 +22,7 @@
 
 #include "roux.h"
 #include "cfop.h"
+#include "l6e_table.h"
 
 #include <chrono>
 #include <algorithm>
@@ -47,8 +48,13 @@ namespace grcube3
             CasesCOLL[i].clear();
         }
 		 
-        MaxDepthFB = MaxDepthSBFS = MaxDepthSBSS = MaxDepthL6E = MaxDepthL6EO = 0u;
+        MaxDepthFB = MaxDepthSBFS = MaxDepthSBSS = 0u;
         TimeFB = TimeSBFS = TimeSBSS = TimeCMLL = TimeCOLL = TimeL6EO = TimeL6E2E = TimeL6E = 0.0;
+        PoolTimeStart = ThreadPool::Get().GetSavedTime();
+        TimeLimit = 0.0;
+        Transpositions.Resize(0u);
+        Truncated = false;
+        ThreadsFB.clear();
 
 		SearchSpins.clear();
 		for (int s = 0; s < 24; s++) SearchSpins.push_back(static_cast<Spn>(s));
@@ -60,6 +66,7 @@ namespace grcube3
 	// Return false if no first blocks found
     bool Roux::SearchFirstBlock(const uint MaxDepth, const uint MaxSolves)
 	{
+        StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
         const auto time_fb_start = std::chrono::system_clock::now();
 
         MaxDepthFB = (MaxDepth <= 4u ? 4u : MaxDepth);
@@ -116,11 +123,17 @@ namespace grcube3
         for (uint l = 4u; l < MaxDepthFB; l++) DSFB.AddSearchLevel(L_Check); // Levels 4 to MaxDepth
 
         DSFB.UpdateRootData();
+        DSFB.SetPruning(true); // Use pruning tables for the pieces to solve
+        DSFB.SetBidirectional(true); // Meet in the middle search (forwards from the scramble, backwards from the solved pieces)
 		// DSFB.SetMinDeep(DSFB.GetMaxDepth() - 2u);
 
+        DSFB.SetDeadline(StageDeadline);
+        DSFB.SetTranspositionTable(&Transpositions);
         DSFB.Run(Cores);
+        if (DSFB.IsTruncated()) Truncated = true;
 
         Cores = DSFB.GetCoresUsed(); // Update to the real number of cores used
+        ThreadsFB = DSFB.GetThreadsReport();
 
         EvaluateFirstBlock(DSFB.Solves, MaxSolves);
 
@@ -161,6 +174,7 @@ namespace grcube3
     // Search the best second block first square solve algorithm with the given search depth
 	void Roux::SearchSecondBlocksFirstSquare(const uint MaxDepth)
     {
+        StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
         const auto time_sb_start = std::chrono::system_clock::now();
 
         MaxDepthSBFS = (MaxDepth <= 4u ? 4u : MaxDepth);
@@ -230,7 +244,10 @@ namespace grcube3
 
 				DSSB.UpdateRootData();
 
+				DSSB.SetDeadline(StageDeadline);
+				DSSB.SetTranspositionTable(&Transpositions);
 				DSSB.Run(Cores);
+				if (DSSB.IsTruncated()) Truncated = true;
 				
 				Cores = DSSB.GetCoresUsed(); // Update to the real number of cores used
 
@@ -258,6 +275,7 @@ namespace grcube3
 	// Complete the second square for the second blocks
     void Roux::SearchSecondBlocksSecondSquare(const uint MaxDepth)
     {
+        StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
         auto time_SBSS_start = std::chrono::system_clock::now();
 
 		MaxDepthSBSS = (MaxDepth <= 4u ? 4u : MaxDepth);
@@ -339,7 +357,10 @@ namespace grcube3
 
 				DSSB.UpdateRootData();
 
+				DSSB.SetDeadline(StageDeadline);
+				DSSB.SetTranspositionTable(&Transpositions);
 				DSSB.Run(Cores);
+				if (DSSB.IsTruncated()) Truncated = true;
 
 				std::vector<Algorithm> Solves;
 				// This function is made for CFOP, but, without the cross check ('false' parameter), is useful here
@@ -435,22 +456,12 @@ namespace grcube3
         TimeCOLL = COLL_elapsed_seconds.count();
 	}
 
-    // Search the last six edges (U & M layer movements)
-    void Roux::SearchL6E(const uint MaxDepth)
+    // Solve the last six edges (U & M layer movements) with the exact distance table
+    void Roux::SearchL6E()
     {
         const auto time_L6E_start = std::chrono::system_clock::now();
 
-        MaxDepthL6E = (MaxDepth <= 4u ? 4u : MaxDepth);
-
-        // First level is extended in the search to improve the multithreading
-        const SearchUnit U_Root(SequenceType::TRIPLE, Sst::SINGLE_UM);
-        const SearchUnit U_Level(SequenceType::SINGLE, Sst::SINGLE_UM);
-
-        SearchLevel L_Root(SearchCheck::NO_CHECK);
-        L_Root.Add(U_Root);
-
-        SearchLevel L_Check(SearchCheck::CHECK);
-        L_Check.Add(U_Level);
+        const L6ETable& Table = L6ETable::Get();
 
 		for (const auto spin : SearchSpins)
 		{
@@ -476,34 +487,7 @@ namespace grcube3
 
 				if (!AreFirstBlocksBuilt(CubeRoux) || CubeRoux.IsSolved()) continue;
 
-				// Auxiliar deep search for last six edges in 3 movements (very fast)
-				DeepSearch PreDSL6E(AlgStart, Plc::SHORT);
-				PreDSL6E.AddToMandatoryPieces(Pgr::ALL); // Search the full cube
-				PreDSL6E.AddSearchLevel(L_Check);
-				PreDSL6E.AddSearchLevel(L_Check);
-				PreDSL6E.AddSearchLevel(L_Check);
-				PreDSL6E.UpdateRootData();
-				PreDSL6E.Run(Cores);
-				if (!PreDSL6E.Solves.empty())
-				{
-					PreDSL6E.EvaluateShortestResult(AlgL6E[sp][n], true);
-					continue; // L6E solve in three movements found
-				}
-				
-				// Full deep search for last six edges
-				DeepSearch DSL6E(AlgStart, Plc::SHORT);
-
-				DSL6E.AddToMandatoryPieces(Pgr::ALL); // Search the full cube
-
-				DSL6E.AddSearchLevel(L_Root); // Level 1 (three steps -TRIPLE- root algorithms
-				for (uint l = 2; l < MaxDepthL6E; l++) DSL6E.AddSearchLevel(L_Check); // Levels 4 to MaxDepth
-
-				DSL6E.UpdateRootData();
-				DSL6E.SetMinDeep(DSL6E.GetMaxDeep() - 4u);
-
-				DSL6E.Run(Cores);
-
-				DSL6E.EvaluateShortestResult(AlgL6E[sp][n], true);
+				Table.Solve(CubeRoux, L6e::ALL, AlgL6E[sp][n]); // Optimal solve (empty if the corners are not solved)
 			}
         }
 
@@ -511,23 +495,12 @@ namespace grcube3
         TimeL6E = L6E_elapsed_seconds.count();
     }
 	
-	// Search the last six edges orientated (U & M layer movements) with the given search deep
-    void Roux::SearchL6EO(const uint MaxDepth)
+	// Solve the last six edges orientation (U & M layer movements) with the exact distance table
+    void Roux::SearchL6EO()
     {
         const auto time_L6EO_start = std::chrono::system_clock::now();
 
-        MaxDepthL6EO = (MaxDepth <= 4u ? 4u : MaxDepth);
-
-        // First level is extended in the search to improve the multithreading - first three levels will not be checked
-        // (it's supose that the last six edges will not be solved in three movements)
-        const SearchUnit U_Root(SequenceType::TRIPLE, Sst::SINGLE_UM);
-        const SearchUnit U_Level(SequenceType::SINGLE, Sst::SINGLE_UM);
-
-        SearchLevel L_Root(SearchCheck::NO_CHECK);
-        L_Root.Add(U_Root);
-
-        SearchLevel L_Check(SearchCheck::CHECK);
-        L_Check.Add(U_Level);
+        const L6ETable& Table = L6ETable::Get();
 
 		for (const auto spin : SearchSpins)
 		{
@@ -535,41 +508,6 @@ namespace grcube3
 
             AlgL6EO[sp].clear();
 
-			Pgr B1, B2, CORNERS, EDGES;
-
-			switch (static_cast<Spn>(sp))
-			{
-			case Spn::UF: B1 = Pgr::UF_B1; B2 = Pgr::UF_B2;	CORNERS = Pgr::CORNERS_U; EDGES = Pgr::ROUX_L6E_UF; break;
-			case Spn::UB: B1 = Pgr::UB_B1; B2 = Pgr::UB_B2;	CORNERS = Pgr::CORNERS_U; EDGES = Pgr::ROUX_L6E_UB; break;
-			case Spn::UR: B1 = Pgr::UR_B1; B2 = Pgr::UR_B2; CORNERS = Pgr::CORNERS_U; EDGES = Pgr::ROUX_L6E_UR; break;
-			case Spn::UL: B1 = Pgr::UL_B1; B2 = Pgr::UL_B2; CORNERS = Pgr::CORNERS_U; EDGES = Pgr::ROUX_L6E_UL; break;
-
-			case Spn::DF: B1 = Pgr::DF_B1; B2 = Pgr::DF_B2; CORNERS = Pgr::CORNERS_D; EDGES = Pgr::ROUX_L6E_DF; break;
-			case Spn::DB: B1 = Pgr::DB_B1; B2 = Pgr::DB_B2; CORNERS = Pgr::CORNERS_D; EDGES = Pgr::ROUX_L6E_DB; break;
-			case Spn::DR: B1 = Pgr::DR_B1; B2 = Pgr::DR_B2; CORNERS = Pgr::CORNERS_D; EDGES = Pgr::ROUX_L6E_DR; break;
-			case Spn::DL: B1 = Pgr::DL_B1; B2 = Pgr::DL_B2; CORNERS = Pgr::CORNERS_D; EDGES = Pgr::ROUX_L6E_DL; break;
-
-			case Spn::FU: B1 = Pgr::FU_B1; B2 = Pgr::FU_B2; CORNERS = Pgr::CORNERS_F; EDGES = Pgr::ROUX_L6E_FU; break;
-			case Spn::FD: B1 = Pgr::FD_B1; B2 = Pgr::FD_B2; CORNERS = Pgr::CORNERS_F; EDGES = Pgr::ROUX_L6E_FD; break;
-			case Spn::FR: B1 = Pgr::FR_B1; B2 = Pgr::FR_B2; CORNERS = Pgr::CORNERS_F; EDGES = Pgr::ROUX_L6E_FR; break;
-			case Spn::FL: B1 = Pgr::FL_B1; B2 = Pgr::FL_B2; CORNERS = Pgr::CORNERS_F; EDGES = Pgr::ROUX_L6E_FL; break;
-
-			case Spn::BU: B1 = Pgr::BU_B1; B2 = Pgr::BU_B2; CORNERS = Pgr::CORNERS_B; EDGES = Pgr::ROUX_L6E_BU; break;
-			case Spn::BD: B1 = Pgr::BD_B1; B2 = Pgr::BD_B2; CORNERS = Pgr::CORNERS_B; EDGES = Pgr::ROUX_L6E_BD; break;
-			case Spn::BR: B1 = Pgr::BR_B1; B2 = Pgr::BR_B2; CORNERS = Pgr::CORNERS_B; EDGES = Pgr::ROUX_L6E_BR; break;
-			case Spn::BL: B1 = Pgr::BL_B1; B2 = Pgr::BL_B2; CORNERS = Pgr::CORNERS_B; EDGES = Pgr::ROUX_L6E_BL; break;
-
-			case Spn::RU: B1 = Pgr::RU_B1; B2 = Pgr::RU_B2; CORNERS = Pgr::CORNERS_R; EDGES = Pgr::ROUX_L6E_RU; break;
-			case Spn::RD: B1 = Pgr::RD_B1; B2 = Pgr::RD_B2; CORNERS = Pgr::CORNERS_R; EDGES = Pgr::ROUX_L6E_RD; break;
-			case Spn::RF: B1 = Pgr::RF_B1; B2 = Pgr::RF_B2; CORNERS = Pgr::CORNERS_R; EDGES = Pgr::ROUX_L6E_RF; break;
-			case Spn::RB: B1 = Pgr::RB_B1; B2 = Pgr::RB_B2; CORNERS = Pgr::CORNERS_R; EDGES = Pgr::ROUX_L6E_RB; break;
-
-			case Spn::LU: B1 = Pgr::LU_B1; B2 = Pgr::LU_B2; CORNERS = Pgr::CORNERS_L; EDGES = Pgr::ROUX_L6E_LU; break;
-			case Spn::LD: B1 = Pgr::LD_B1; B2 = Pgr::LD_B2; CORNERS = Pgr::CORNERS_L; EDGES = Pgr::ROUX_L6E_LD; break;
-			case Spn::LF: B1 = Pgr::LF_B1; B2 = Pgr::LF_B2; CORNERS = Pgr::CORNERS_L; EDGES = Pgr::ROUX_L6E_LF; break;
-			case Spn::LB: B1 = Pgr::LB_B1; B2 = Pgr::LB_B2; CORNERS = Pgr::CORNERS_L; EDGES = Pgr::ROUX_L6E_LB; break;
-			}
-
 			for (uint n = 0u; n < FirstBlocks[sp].size(); n++)
 			{
                 AlgL6EO[sp].push_back(Algorithm(""));
@@ -586,21 +524,7 @@ namespace grcube3
 
 				if (!AreFirstBlocksBuilt(CubeRoux) || IsL6EOriented(CubeRoux)) continue; // Last six edges already oriented or no solve
 
-                DeepSearch DSOL6EO(AlgStart, Plc::SHORT); // Deep search for last six edges
-
-                DSOL6EO.AddToMandatoryPieces(B1);
-                DSOL6EO.AddToMandatoryPieces(B2);
-                DSOL6EO.AddToMandatoryPieces(CORNERS);
-                DSOL6EO.AddToMandatoryOrientations(EDGES);
-
-                DSOL6EO.AddSearchLevel(L_Root); // Level 1 (three steps -TRIPLE- root algorithms
-                for (uint l = 2; l < MaxDepthL6EO; l++) DSOL6EO.AddSearchLevel(L_Check); // Levels 4 to MaxDepth
-
-                DSOL6EO.UpdateRootData();
-
-                DSOL6EO.Run(Cores);
-
-                DSOL6EO.EvaluateShortestResult(AlgL6EO[sp][n], true);
+                Table.Solve(CubeRoux, L6e::EO, AlgL6EO[sp][n]); // Optimal solve (first blocks and corners solved)
 			}
         }
 
@@ -608,23 +532,12 @@ namespace grcube3
         TimeL6EO = L6EO_elapsed_seconds.count();
     }
 
-	// Search the UR & UL edges (L6E)
-    void Roux::SearchL6E2E(const uint MaxDepth)
+	// Solve the UR & UL edges (L6E) with the exact distance table
+    void Roux::SearchL6E2E()
     {
         const auto time_L6E2E_start = std::chrono::system_clock::now();
 
-        MaxDepthL6E2E = (MaxDepth <= 4u ? 4u : MaxDepth);
-
-        // First level is extended in the search to improve the multithreading - first two levels will not be checked
-        // (it's supose that the last six edges will not be solved in two movements)
-        SearchUnit U_Root(SequenceType::DOUBLE, Sst::SINGLE_UM);
-        SearchUnit U_Level(SequenceType::SINGLE, Sst::SINGLE_UM);
-
-        SearchLevel L_Root(SearchCheck::NO_CHECK);
-        L_Root.Add(U_Root);
-
-        SearchLevel L_Check(SearchCheck::CHECK);
-        L_Check.Add(U_Level);
+        const L6ETable& Table = L6ETable::Get();
 
 		for (const auto spin : SearchSpins)
 		{
@@ -632,38 +545,6 @@ namespace grcube3
 
             AlgL6E2E[sp].clear();
 
-			Pgr LR, LL, LM;
-
-			switch (static_cast<Spn>(sp))
-			{
-			case Spn::UF:
-			case Spn::UB:
-			case Spn::DF:
-			case Spn::DB:
-			case Spn::FU:
-			case Spn::FD:
-			case Spn::BU:
-			case Spn::BD: LR = Pgr::LAYER_R; LL = Pgr::LAYER_L; LM = Pgr::LAYER_M; break;
-
-			case Spn::UR:
-			case Spn::UL:
-			case Spn::DR:
-			case Spn::DL:
-			case Spn::RU:
-			case Spn::RD:
-			case Spn::LU:
-			case Spn::LD: LR = Pgr::LAYER_F; LL = Pgr::LAYER_B; LM = Pgr::LAYER_S; break;
-
-			case Spn::FR:
-			case Spn::FL:
-			case Spn::BR:
-			case Spn::BL:
-			case Spn::RF:
-			case Spn::RB:
-			case Spn::LF:
-			case Spn::LB: LR = Pgr::LAYER_U; LL = Pgr::LAYER_D; LM = Pgr::LAYER_E; break;
-			}
-
 			for (uint n = 0u; n < FirstBlocks[sp].size(); n++)
 			{
                 AlgL6E2E[sp].push_back(Algorithm(""));
@@ -681,20 +562,7 @@ namespace grcube3
 
                 if (!IsL6EOriented(CubeRoux) || IsL6EO2E(CubeRoux)) continue; // L6E two edges solved or no solve
 
-                DeepSearch DSL6E2E(AlgStart, Plc::SHORT); // Deep search for last six edges (UR & UL edges)
-
-                DSL6E2E.AddToMandatoryPieces(LR);
-                DSL6E2E.AddToMandatoryPieces(LL);
-                DSL6E2E.AddToMandatoryOrientations(LM);
-
-                DSL6E2E.AddSearchLevel(L_Root); // Level 1 (three steps -TRIPLE- root algorithms
-                for (uint l = 2; l < MaxDepthL6E2E; l++) DSL6E2E.AddSearchLevel(L_Check); // Levels 4 to MaxDepth
-
-                DSL6E2E.UpdateRootData();
-
-                DSL6E2E.Run(Cores);
-
-                DSL6E2E.EvaluateShortestResult(AlgL6E2E[sp][n], true);
+                Table.Solve(CubeRoux, L6e::E2E, AlgL6E2E[sp][n]); // Optimal solve (left and right layers solved, M layer oriented)
 			}
 		}
 
@@ -1277,6 +1145,9 @@ namespace grcube3
         Report += "L6E search time: " + std::to_string(GetTimeL6E() + GetTimeL6EO() + GetTimeL6E2E()) + " s\n";
         Report += "Threads used: " + std::to_string(GetUsedCores() > 0 ? GetUsedCores() : 0) +
                   " of " + std::to_string(DeepSearch::GetSystemCores()) + "\n";
+        Report += "Threads pool time saved: " + std::to_string(ThreadPool::Get().GetSavedTime() - PoolTimeStart) + " s\n";
+        if (IsTruncated()) Report += "Some searches were truncated by the time limit\n";
+        if (!ThreadsFB.empty()) Report += "First blocks search threads:\n" + ThreadsFB;
 
         return Report;
     }
@@ -57,6 +57,15 @@ namespace grcube3
 		// Set the metric for evaluations
 		void SetMetric(const Metrics m) { Metric = m; }
 
+		// Set the time limit for each search stage in seconds (0 = no limit), a stage out of time keeps the solves found so far
+		void SetTimeLimit(const double t) { TimeLimit = t; }
+
+		// Set the transposition table size for the searches (2 ^ given bits slots, 0 = no transposition table)
+		void SetTranspositionTable(const uint b) { Transpositions.Resize(b); }
+
+		// Check if any search stage has been truncated by the time limit
+		bool IsTruncated() const { return Truncated; }
+
         // Search the best first block solve with the given search deep and the maximun number of solves
 		// Return false if no first block found
         bool SearchFirstBlock(const uint, const uint = 1u);
@@ -68,9 +77,9 @@ namespace grcube3
 		void SearchCMLL(const bool = false);
 		void SearchCOLL(const bool = false);
 
-        void SearchL6EO(const uint); // Search the last six edges orientated (U & M layer movements) with the given search depth
-        void SearchL6E2E(const uint); // Search UR & UL edges in the last six edges (U & M layer movements) with the given search depth
-        void SearchL6E(const uint); // Search the last six edges (U & M layer movements) with the given search deep
+        void SearchL6EO(); // Solve the last six edges orientation (U & M layer movements, optimal solve from the distance table)
+        void SearchL6E2E(); // Solve UR & UL edges in the last six edges (U & M layer movements, optimal solve from the distance table)
+        void SearchL6E(); // Solve the last six edges (U & M layer movements, optimal solve from the distance table)
 
         // Search the best first block solve algorithms from an algorithms vector
         void EvaluateFirstBlock(const std::vector<Algorithm>&, const uint = 1u);
@@ -199,7 +208,7 @@ namespace grcube3
 		Metrics Metric; // Metric for measures
 
 		// Last used maximum first blocks deep
-        uint MaxDepthFB, MaxDepthSBFS, MaxDepthSBSS, MaxDepthL6EO, MaxDepthL6E2E, MaxDepthL6E;
+        uint MaxDepthFB, MaxDepthSBFS, MaxDepthSBSS;
 		
         std::vector<std::string> CasesCMLL[24], // CMLL cases found for each spin
                                  CasesCOLL[24]; // COLL cases found for each spin
@@ -209,6 +218,12 @@ namespace grcube3
 
 		// Times
         double TimeFB, TimeSBFS, TimeSBSS, TimeCMLL, TimeCOLL, TimeL6EO, TimeL6E2E, TimeL6E;
+        double PoolTimeStart; // Threads pool saved time when the search was reset
+        double TimeLimit; // Time limit for each search stage (seconds)
+        TranspositionTable Transpositions; // Transposition table reused by all the searches
+        std::chrono::steady_clock::time_point StageDeadline; // Deadline for the current search stage
+        bool Truncated; // Some search stage has been truncated by the time limit
+        std::string ThreadsFB; // Threads busy / idle times report for the first blocks search
 
 		// Check if the solves for the given spin are consistent (all needed algorithms are present)
 		bool CheckSolveConsistency(const Spn) const;
@@ -0,0 +1,141 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#pragma once
+
+#include <cstring>
+#include <algorithm>
+
+#include "cube_definitions.h"
+
+namespace grcube3
+{
+	// Steps list for the algorithms: the steps are stored in the object itself up to the inline capacity (enough for
+	// scrambles, crosses, F2L pairs and last layer algorithms), and only longer lists use the heap
+	// The interface is the std::vector subset used by the algorithms
+	class StepBuffer
+	{
+	public:
+		static constexpr uint InlineCapacity = 24u; // Steps stored without heap memory
+
+		StepBuffer() : Size(0u), Capacity(InlineCapacity) { }
+		StepBuffer(const StepBuffer& B) : StepBuffer() { Copy(B); }
+		StepBuffer(StepBuffer&& B) noexcept : StepBuffer() { Move(B); }
+		~StepBuffer() { Release(); }
+
+		StepBuffer& operator=(const StepBuffer& B) { if (this != &B) Copy(B); return *this; }
+		StepBuffer& operator=(StepBuffer&& B) noexcept { if (this != &B) { Release(); Move(B); } return *this; }
+
+		Stp* begin() { return Data(); }
+		Stp* end() { return Data() + Size; }
+		const Stp* begin() const { return Data(); }
+		const Stp* end() const { return Data() + Size; }
+
+		Stp& operator[](const uint pos) { return Data()[pos]; }
+		const Stp& operator[](const uint pos) const { return Data()[pos]; }
+		Stp& front() { return Data()[0]; }
+		Stp front() const { return Data()[0]; }
+		Stp& back() { return Data()[Size - 1u]; }
+		Stp back() const { return Data()[Size - 1u]; }
+
+		std::size_t size() const { return Size; }
+		std::size_t capacity() const { return Capacity; }
+		bool empty() const { return Size == 0u; }
+		void clear() { Size = 0u; }
+
+		void reserve(const std::size_t n) { if (n > Capacity) Grow(static_cast<uint>(n)); }
+
+		void push_back(const Stp s)
+		{
+			if (Size == Capacity) Grow(Size + 1u);
+			Data()[Size++] = s;
+		}
+		void pop_back() { Size--; }
+
+		Stp* insert(const Stp* pos, const Stp s) // Insert a step before the given position
+		{
+			const uint p = static_cast<uint>(pos - Data());
+			if (Size == Capacity) Grow(Size + 1u);
+			Stp* D = Data();
+			std::memmove(D + p + 1u, D + p, Size - p);
+			D[p] = s;
+			Size++;
+			return D + p;
+		}
+		Stp* erase(const Stp* pos) { return erase(pos, pos + 1); } // Erase the step in the given position
+		Stp* erase(const Stp* first, const Stp* last) // Erase the steps in the given range
+		{
+			Stp* D = Data();
+			const uint p = static_cast<uint>(first - D), n = static_cast<uint>(last - first);
+			std::memmove(D + p, D + p + n, Size - p - n);
+			Size -= n;
+			return D + p;
+		}
+
+	private:
+		union
+		{
+			Stp Inline[InlineCapacity]; // Inline steps
+			Stp* Heap; // Heap steps (capacity over the inline capacity)
+		};
+		uint Size, Capacity;
+
+		bool IsInline() const { return Capacity == InlineCapacity; }
+		Stp* Data() { return IsInline() ? Inline : Heap; }
+		const Stp* Data() const { return IsInline() ? Inline : Heap; }
+
+		void Grow(const uint n) // Move the steps to a heap buffer with at least the given capacity
+		{
+			const uint NewCapacity = std::max(n, 2u * Capacity);
+			Stp* NewHeap = new Stp[NewCapacity];
+			std::memcpy(NewHeap, Data(), Size);
+			Release();
+			Heap = NewHeap;
+			Capacity = NewCapacity;
+		}
+
+		void Release() { if (!IsInline()) { delete[] Heap; Capacity = InlineCapacity; } }
+
+		void Copy(const StepBuffer& B)
+		{
+			if (B.Size > Capacity) { Size = 0u; Grow(B.Size); }
+			std::memcpy(Data(), B.Data(), B.Size);
+			Size = B.Size;
+		}
+
+		void Move(StepBuffer& B) // The source buffer is left empty
+		{
+			if (B.IsInline()) std::memcpy(Inline, B.Inline, B.Size);
+			else
+			{
+				Heap = B.Heap;
+				Capacity = B.Capacity;
+				B.Capacity = InlineCapacity;
+			}
+			Size = B.Size;
+			B.Size = 0u;
+		}
+	};
+
+	static_assert(sizeof(Stp) == 1u, "The steps buffer copies the steps as bytes");
+}
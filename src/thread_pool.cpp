@@ -0,0 +1,106 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#include <chrono>
+
+#include "thread_pool.h"
+
+namespace grcube3
+{
+	// Get the shared threads pool
+	ThreadPool& ThreadPool::Get()
+	{
+		static ThreadPool Pool;
+		return Pool;
+	}
+
+	// Start the threads -> -1: no threads, 0: a thread for each core, other: specified number of threads
+	void ThreadPool::Start(const int UseThreads)
+	{
+		if (UseThreads < 0) return;
+		std::lock_guard<std::mutex> guard(RunMutex);
+		AddThreads(UseThreads == 0 ? std::thread::hardware_concurrency() : static_cast<uint>(UseThreads));
+	}
+
+	// Run a job in the pool threads for each index from 0 to the given number, returns when all jobs are completed
+	void ThreadPool::Run(const uint Size, const std::function<void(const uint)>& J)
+	{
+		if (Size == 0u) return;
+		std::lock_guard<std::mutex> guard(RunMutex);
+
+		const uint Reused = Size < Threads.size() ? Size : static_cast<uint>(Threads.size());
+		AddThreads(Size);
+		ReusedStarts += Reused;
+
+		std::unique_lock<std::mutex> lock(JobMutex);
+		Job = &J;
+		JobSize = PendingIndexes = Size;
+		NextIndex = 0u;
+		JobStart.notify_all();
+		JobEnd.wait(lock, [this] { return PendingIndexes == 0u; });
+		Job = nullptr;
+		JobSize = NextIndex = 0u;
+	}
+
+	// Start new threads until the given number of threads (the time to start and join a thread is measured)
+	void ThreadPool::AddThreads(const uint Size)
+	{
+		if (Threads.size() >= Size) return;
+
+		const auto time_start = std::chrono::system_clock::now();
+		std::thread([] {}).join();
+		const std::chrono::duration<double> thread_elapsed_seconds = std::chrono::system_clock::now() - time_start;
+		ThreadTime = (ThreadTime * ThreadTimeSamples + thread_elapsed_seconds.count()) / (ThreadTimeSamples + 1u);
+		ThreadTimeSamples++;
+
+		while (Threads.size() < Size) Threads.push_back(std::thread(&ThreadPool::Worker, this));
+	}
+
+	// Pool thread main loop: run the job indexes until the pool is stopped
+	void ThreadPool::Worker()
+	{
+		std::unique_lock<std::mutex> lock(JobMutex);
+		while (true)
+		{
+			JobStart.wait(lock, [this] { return Stop || NextIndex < JobSize; });
+			if (Stop) return;
+
+			const uint Index = NextIndex++;
+			lock.unlock();
+			(*Job)(Index);
+			lock.lock();
+			if (--PendingIndexes == 0u) JobEnd.notify_all();
+		}
+	}
+
+	// Stop and join all threads
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(JobMutex);
+			Stop = true;
+		}
+		JobStart.notify_all();
+		for (auto& t : Threads) t.join();
+	}
+}
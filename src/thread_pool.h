@@ -0,0 +1,79 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "cube_definitions.h"
+
+namespace grcube3
+{
+	// Process-wide threads pool for the searches: the threads are started once and reused by every search,
+	// so the many short searches in a solve don't create and join their own threads
+	class ThreadPool
+	{
+	public:
+		static ThreadPool& Get(); // Get the shared threads pool
+
+		// Start the threads -> -1: no threads, 0: a thread for each core, other: specified number of threads
+		// More threads are started later if a search needs them
+		void Start(const int);
+
+		// Run a job in the pool threads for each index from 0 to the given number, returns when all jobs are completed
+		// Jobs can't be nested (a job must not run other jobs in the pool)
+		void Run(const uint, const std::function<void(const uint)>&);
+
+		uint GetThreads() const { return static_cast<uint>(Threads.size()); } // Get the number of threads in the pool
+		S64 GetReusedStarts() const { return ReusedStarts; } // Get the number of thread starts avoided by reusing the pool threads
+
+		// Get the time saved by reusing the pool threads (estimated from the measured time to start and join a thread)
+		double GetSavedTime() const { return ReusedStarts * ThreadTime; }
+
+		~ThreadPool(); // Stop and join all threads
+
+	private:
+		ThreadPool() {}
+
+		std::vector<std::thread> Threads; // Pool threads
+		std::mutex RunMutex, // Only a job can be running at a time
+				   JobMutex; // Mutex for the current job data
+		std::condition_variable JobStart, JobEnd; // Job data changes
+		const std::function<void(const uint)>* Job = nullptr; // Current job
+		uint JobSize = 0u, // Number of indexes in the current job
+			 NextIndex = 0u, // Next index to run in the current job
+			 PendingIndexes = 0u; // Indexes not completed in the current job
+		bool Stop = false; // Stop the threads
+
+		double ThreadTime = 0.0; // Average time to start and join a thread (seconds)
+		uint ThreadTimeSamples = 0u; // Measures of the time to start and join a thread
+		S64 ReusedStarts = 0ull; // Thread starts avoided
+
+		void AddThreads(const uint); // Start new threads until the given number of threads
+		void Worker(); // Pool thread main loop
+	};
+}
@@ -0,0 +1,64 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#include "transposition.h"
+
+namespace grcube3
+{
+	// Set the table size (2 ^ given bits slots, all empty), 0 to free the table
+	void TranspositionTable::Resize(const uint Bits)
+	{
+		if (Bits == 0u)
+		{
+			Slots.reset();
+			Mask = 0ull;
+			return;
+		}
+		const S64 Size = 1ull << Bits;
+		if (Size - 1ull == Mask) return;
+		Slots.reset(new Slot[Size]()); // Zero initialized (empty slots)
+		Mask = Size - 1ull;
+		Generation = 0u;
+	}
+
+	// Get the generation for a new search (the nodes from previous searches are not valid)
+	uint TranspositionTable::NewSearch()
+	{
+		if (++Generation < Generations) return Generation;
+		Clear(); // The generations wrap around, the old nodes could match again
+		Generation = 1u;
+		return Generation;
+	}
+
+	// Remove all nodes from the table
+	void TranspositionTable::Clear()
+	{
+		if (Mask == 0ull) return;
+		for (S64 i = 0ull; i <= Mask; i++)
+		{
+			Slots[i].Edges.store(0ull, std::memory_order_relaxed);
+			Slots[i].Corners.store(0ull, std::memory_order_relaxed);
+			Slots[i].Check.store(0ull, std::memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,97 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "cube.h"
+
+namespace grcube3
+{
+	// Lock-free transposition table for the search: a fixed size array with the visited search nodes, a node already in
+	// the table doesn't need to be searched again. A node is the cube state, the search depth and the data that gives the
+	// successors of the node (last two steps and sequence position), so two nodes with the same key have the same subtree
+	// Each slot keeps only the last node stored in it (a node can be searched again after being replaced). The full key
+	// is stored, so a hit is always verified, and the check word detects the slots mixed by concurrent writes
+	// The table is reused by consecutive searches: each search gets a new generation, stored in the check word, so the
+	// nodes from other searches never match and the table is cleared only when the generations wrap around (the searches
+	// that share a table must run one after another)
+	class TranspositionTable
+	{
+	public:
+		void Resize(const uint); // Set the table size (2 ^ given bits slots, all empty), 0 to free the table
+		void Clear(); // Remove all nodes from the table
+
+		bool Empty() const { return Mask == 0ull; } // Check if the table has no slots
+
+		uint NewSearch(); // Get the generation for a new search (the nodes from previous searches are not valid)
+
+		// Check if the node is in the table for the given search generation, else add it to the table
+		// The sequence identifier is truncated to 16 bits (the units in a search are created together)
+		bool Visit(const Cube& C, const uint Deep, const Stp Last, const Stp Penultimate, const uint SeqId, const uint SeqSize,
+				   const uint Generation)
+		{
+			const S64 E = C.GetEdgesStatus(), Cn = C.GetCornersStatus(),
+					  Info = (static_cast<S64>(SeqId & 0xFFFFu) << 31) | (static_cast<S64>(SeqSize & 0x3u) << 29) |
+							 (static_cast<S64>(Penultimate) << 21) | (static_cast<S64>(Last) << 13) |
+							 (static_cast<S64>(C.GetSpin()) << 8) | (Deep & 0xFFu),
+					  Key = Info | (static_cast<S64>(Generation) << GenerationShift);
+			Slot& S = Slots[Hash(E, Cn, Info) & Mask];
+			const S64 SE = S.Edges.load(std::memory_order_relaxed), SC = S.Corners.load(std::memory_order_relaxed),
+					  SK = S.Check.load(std::memory_order_relaxed);
+			if (SE == E && SC == Cn && (SK ^ SE ^ SC) == Key) return true;
+			S.Edges.store(E, std::memory_order_relaxed);
+			S.Corners.store(Cn, std::memory_order_relaxed);
+			S.Check.store(Key ^ E ^ Cn, std::memory_order_relaxed);
+			return false;
+		}
+
+	private:
+		struct Slot
+		{
+			std::atomic<S64> Edges, Corners, // Cube state (zero edges for an empty slot)
+							 Check; // Node data xor cube state
+		};
+
+		std::unique_ptr<Slot[]> Slots; // Nodes
+		S64 Mask = 0ull; // Number of slots - 1
+
+		static constexpr uint GenerationShift = 47u; // Generation position in the node key (the node data is below)
+		static constexpr uint Generations = 1u << (64u - GenerationShift); // Generations before the table is cleared
+		uint Generation = 0u; // Last search generation (0 is never used, so the empty slots don't match)
+
+		// Hash for the node key
+		static S64 Hash(const S64 E, const S64 Cn, const S64 Info)
+		{
+			S64 h = E * 0x9E3779B97F4A7C15ull;
+			h ^= (h >> 32) ^ (Cn * 0xC2B2AE3D27D4EB4Full);
+			h ^= Info * 0x165667B19E3779F9ull;
+			h ^= h >> 31;
+			h *= 0x94D049BB133111EBull;
+			h ^= h >> 29;
+			return h;
+		}
+	};
+}
@@ -22,6 +22,7 @@
 
 #include "zz.h"
 #include "cfop.h"
+#include "cube_batch.h"
 
 #include <chrono>
 #include <algorithm>
@@ -54,6 +55,12 @@ namespace grcube3
 		
         MaxDepthEOX = 0u;
         TimeEOX = TimeF2L = TimeZBLL = TimeOCLL = TimePLL = TimeCOLL = TimeEPLL = 0.0;
+        PoolTimeStart = ThreadPool::Get().GetSavedTime();
+        LookupsStart = LLIndex::GetLookups();
+        TimeLimit = 0.0;
+        Transpositions.Resize(0u);
+        Truncated = false;
+        ThreadsEOX.clear();
 		
 		Metric = Metrics::Movements; // Default metric
 	}
@@ -62,6 +69,7 @@ namespace grcube3
     // Return false if no EOX found
     bool ZZ::SearchEOX(const uint MaxDepth, const uint MaxSolves)
 	{
+        StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
         const auto time_EOX_start = std::chrono::system_clock::now();
 
         MaxDepthEOX = (MaxDepth <= 4u ? 4u : MaxDepth);
@@ -100,11 +108,17 @@ namespace grcube3
         for (uint l = 2u; l < MaxDepthEOX; l++) DSEOX.AddSearchLevel(L_Check);
 
         DSEOX.UpdateRootData();
+        DSEOX.SetPruning(true); // Use pruning tables for the pieces to solve
+        DSEOX.SetBidirectional(true); // Meet in the middle search (forwards from the scramble, backwards from the solved pieces)
         // DSEOX.SetMinDeep(DSEOX.GetMaxDeep() - 2u);
 
+        DSEOX.SetDeadline(StageDeadline);
+        DSEOX.SetTranspositionTable(&Transpositions);
         DSEOX.Run(Cores);
+        if (DSEOX.IsTruncated()) Truncated = true;
 
         Cores = DSEOX.GetCoresUsed(); // Update to the real number of cores used
+        ThreadsEOX = DSEOX.GetThreadsReport();
 
         EvaluateEOX(DSEOX.Solves, MaxSolves);
 
@@ -145,6 +159,7 @@ namespace grcube3
     // Complete the two first layers (F2L)
     void ZZ::SearchF2L()
     {
+        StageDeadline = DeepSearch::GetDeadline(TimeLimit); // Deadline for the searches in this stage
         const auto time_F2L_start = std::chrono::system_clock::now();
 
         for (const auto spin : SearchSpins)
@@ -321,7 +336,10 @@ namespace grcube3
             if (SQUARE_R2_IsSolved) DS_F2L.AddToMandatoryPieces(SQUARE_R2);
             else DS_F2L.AddToOptionalPieces(SQUARE_R2);
 
+            DS_F2L.SetDeadline(StageDeadline);
+            DS_F2L.SetTranspositionTable(&Transpositions);
             DS_F2L.Run(Cores);
+            if (DS_F2L.IsTruncated()) Truncated = true;
 
             Cores = DS_F2L.GetCoresUsed(); // Update to the real number of cores used
 
@@ -433,7 +451,10 @@ namespace grcube3
             if (F2L_4_IsSolved) DS_F2L.AddToMandatoryPieces(F2L4);
             else DS_F2L.AddToOptionalPieces(F2L4);
 
+            DS_F2L.SetDeadline(StageDeadline);
+            DS_F2L.SetTranspositionTable(&Transpositions);
             DS_F2L.Run(Cores);
+            if (DS_F2L.IsTruncated()) Truncated = true;
 			
 			Cores = DS_F2L.GetCoresUsed(); // Update to the real number of cores used
 
@@ -941,23 +962,56 @@ namespace grcube3
 
         std::vector<std::pair<uint, Algorithm>> ScoredSolves;
 
-		for (const auto& s : Solves)
+        // The solves are applied in batches, with the pieces checks done for all the cubes in the batch (the edges
+        // orientation is checked only for the cubes with the EOLine pieces solved)
+        auto GetMask = [spin](const std::vector<App>& APList)
+        {
+            std::vector<Pcp> PList;
+            for (const auto AP : APList) PList.push_back(Cube::FromAbsPosition(AP, spin));
+            return LanesMask(PList);
+        };
+        const LanesMask LineMask = GetMask({ App::DF, App::DB }),
+                        ArrowMask = GetMask({ App::DF, App::DB, App::DL }),
+                        CrossMask = GetMask({ App::DF, App::DB, App::DR, App::DL }),
+                        XLineMask = GetMask({ App::DF, App::DB, App::DL, App::BL, App::DBL }),
+                        XCrossMask = GetMask({ App::DF, App::DB, App::DR, App::DL, App::BL, App::DBL }),
+                        EO223Mask = GetMask({ App::DF, App::DB, App::DR, App::DL, App::BL, App::FL, App::DBL, App::DFL });
+        CubeBatch Batch;
+        uint LineSolved = 0u, ArrowSolved = 0u, CrossSolved = 0u, XLineSolved = 0u, XCrossSolved = 0u, EO223Solved = 0u;
+
+		for (uint i = 0u; i < Solves.size(); i++)
 		{
+            const uint b = i % CubeBatch::MaxSize; // Solve position in the batch
+            if (b == 0u) // Next batch
+            {
+                const uint Valid = Batch.SetAlgorithms(CBase, Solves, i);
+                for (uint n = 0u; n < Batch.GetSize(); n++) // Algorithms not valid in byte lanes are applied with a cube
+                    if (((Valid >> n) & 1u) == 0u) Batch.SetAlgorithm(n, CBase, Solves[i + n]);
+                LineSolved = Batch.IsSolved(LineMask);
+                ArrowSolved = Batch.IsSolved(ArrowMask);
+                CrossSolved = Batch.IsSolved(CrossMask);
+                XLineSolved = Batch.IsSolved(XLineMask);
+                XCrossSolved = Batch.IsSolved(XCrossMask);
+                EO223Solved = Batch.IsSolved(EO223Mask);
+            }
+
+            const Algorithm& s = Solves[i];
             Score = 0u;
 
-			Cube CheckCube = CBase;
-            CheckCube.ApplyAlgorithm(s);
-			
-            if (!IsEOLineBuilt(CheckCube, spin)) continue;
+            if (((LineSolved >> b) & 1u) == 0u) continue;
+
+			Cube CheckCube = Batch.GetCube(b);
+            CheckCube.SetSpin(spin);
+            if (!CheckCube.EO()) continue;
 
 			Score = (s.GetSize() > 50u ? 0u : 50u - s.GetSize()) * SolveSizeMagnitude;
             Score += s.GetSubjectiveScore();
 			
-            if (IsEO223Built(CheckCube, spin)) Score += SolveEO223Magnitude;
-            else if (IsXEOCrossBuilt(CheckCube, spin)) Score += SolveXEOCrossMagnitude;
-            else if (IsXEOLineBuilt(CheckCube, spin)) Score += SolveXEOLineMagnitude;
-            else if (IsEOCrossBuilt(CheckCube, spin)) Score += SolveEOCrossMagnitude;
-            else if (IsEOArrowBuilt(CheckCube, spin)) Score += SolveEOArrowMagnitude;
+            if ((EO223Solved >> b) & 1u) Score += SolveEO223Magnitude;
+            else if ((XCrossSolved >> b) & 1u) Score += SolveXEOCrossMagnitude;
+            else if ((XLineSolved >> b) & 1u) Score += SolveXEOLineMagnitude;
+            else if ((CrossSolved >> b) & 1u) Score += SolveEOCrossMagnitude;
+            else if ((ArrowSolved >> b) & 1u) Score += SolveEOArrowMagnitude;
 			
             if (Score > 0u)
             {
@@ -1243,8 +1297,14 @@ namespace grcube3
         Report += "EO Line search time: " + std::to_string(GetTimeEOX()) + " s\n";
         Report += "F2L search time: " + std::to_string(GetTimeF2L()) + " s\n";
         Report += "Last layer search time: " + std::to_string(GetTimeLL()) + " s\n";
+
+        Report += LLIndex::GetLookupsReport(LookupsStart);
+
         Report += "Threads used: " + std::to_string(GetUsedCores() > 0 ? GetUsedCores() : 0) +
                   " of " + std::to_string(DeepSearch::GetSystemCores()) + "\n";
+        Report += "Threads pool time saved: " + std::to_string(ThreadPool::Get().GetSavedTime() - PoolTimeStart) + " s\n";
+        if (IsTruncated()) Report += "Some searches were truncated by the time limit\n";
+        if (!ThreadsEOX.empty()) Report += "EOX search threads:\n" + ThreadsEOX;
 
         return Report;
     }
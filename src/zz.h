@@ -24,6 +24,7 @@
 
 #include "cube_definitions.h"
 #include "deep_search.h"
+#include "ll_index.h"
 
 namespace grcube3
 {
@@ -57,6 +58,15 @@ namespace grcube3
 		// Set the metric for evaluations
 		void SetMetric(const Metrics m) { Metric = m; }
 
+		// Set the time limit for each search stage in seconds (0 = no limit), a stage out of time keeps the solves found so far
+		void SetTimeLimit(const double t) { TimeLimit = t; }
+
+		// Set the transposition table size for the searches (2 ^ given bits slots, 0 = no transposition table)
+		void SetTranspositionTable(const uint b) { Transpositions.Resize(b); }
+
+		// Check if any search stage has been truncated by the time limit
+		bool IsTruncated() const { return Truncated; }
+
         // Search the best EOX solve with the given search depth
         // Return false if no EOX found
         bool SearchEOX(const uint, const uint = 1u);
@@ -213,6 +223,13 @@ namespace grcube3
 
 		// Times
         double TimeEOX, TimeF2L, TimeZBLL, TimeOCLL, TimePLL, TimeCOLL, TimeEPLL;
+        double PoolTimeStart; // Threads pool saved time when the search was reset
+        LLIndex::Lookups LookupsStart; // Last layer recognition lookups when the search was reset
+        double TimeLimit; // Time limit for each search stage (seconds)
+        TranspositionTable Transpositions; // Transposition table reused by all the searches
+        std::chrono::steady_clock::time_point StageDeadline; // Deadline for the current search stage
+        bool Truncated; // Some search stage has been truncated by the time limit
+        std::string ThreadsEOX; // Threads busy / idle times report for the EOX search
 
         // Complete the two first layers (F2L) after EO Line (No EO Cross)
         void SearchF2L_EOLine(const Spn, const uint);
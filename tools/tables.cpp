@@ -0,0 +1,117 @@
+/*  This file is part of "GR Cube"
+
+	Copyright (C) 2021 German Ramos Rodriguez
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	German Ramos Rodriguez
+	Vigo, Spain
+	<mailto:grvigo@hotmail.com>
+*/
+
+
+
+// Distance tables generator: generates the named distance tables with a multithreaded breadth-first search and saves
+// them in the current directory (.ssmt files), where the solver maps the 4 bits tables and uses them as pruning tables
+// in the searches for his pieces, instead of generating the pruning tables in each run
+//  ssmaster-tables                  -> List the tables and the state of his files
+//  ssmaster-tables cross petrus     -> Generate the given tables ('all' for all tables)
+//  Options: -b2 / -b4 (bits per entry, 4 by default), -t<threads> (0 by default, a thread for each core),
+//           -v (check the tables files instead of generating them)
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "../src/distance_table.h"
+
+using namespace grcube3;
+
+// Print the table file state
+static bool CheckTable(const DistanceTableDef& Def)
+{
+	DistanceTable T;
+	const auto time_start = std::chrono::steady_clock::now();
+	const bool Valid = T.Load(DistanceTable::GetFilename(Def.Name));
+	const std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - time_start;
+
+	std::cout << std::left << std::setw(10) << Def.Name << std::right;
+	if (Valid) std::cout << " " << T.GetEntries() << " entries, " << T.GetBits() << " bits, max. distance " << T.GetMaxDistance()
+						 << ", loaded and checked in " << std::fixed << std::setprecision(3) << elapsed_seconds.count() << " s" << std::endl;
+	else std::cout << " " << DistanceTable::GetFilename(Def.Name) << " not found or not valid" << std::endl;
+	return Valid;
+}
+
+// Generate and save the table
+static bool GenerateTable(const DistanceTableDef& Def, const uint Bits, const int Threads)
+{
+	std::vector<const Coordinate*> CList;
+	DistanceTable::GetCoordinates(Def, CList);
+
+	std::cout << "Generating " << Def.Name << " table (" << Bits << " bits)... " << std::flush;
+	DistanceTable T;
+	const auto time_start = std::chrono::steady_clock::now();
+	if (!T.Generate(CList, Bits, Threads))
+	{
+		std::cout << "Error!" << std::endl;
+		return false;
+	}
+	const std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - time_start;
+	std::cout << std::fixed << std::setprecision(3) << elapsed_seconds.count() << " s" << std::endl;
+
+	for (uint d = 0u; d < T.GetLevels().size(); d++)
+		std::cout << "\tDistance " << std::setw(2) << d << ": " << std::setw(12) << T.GetLevels()[d] << std::endl;
+
+	const std::string Filename = DistanceTable::GetFilename(Def.Name);
+	const bool Saved = T.Save(Filename);
+	std::cout << "\t" << T.GetEntries() << " entries saved in " << Filename << (Saved ? "" : " -> Error!") << std::endl;
+	return Saved;
+}
+
+int main(int argc, char* argv[])
+{
+	uint Bits = 4u;
+	int Threads = 0;
+	bool Verify = false;
+	std::vector<const DistanceTableDef*> Defs;
+
+	for (int p = 1; p < argc; p++)
+	{
+		const std::string Par = argv[p];
+		if (Par == "-b2") Bits = 2u;
+		else if (Par == "-b4") Bits = 4u;
+		else if (Par.compare(0u, 2u, "-t") == 0 && Par.size() > 2u) Threads = std::stoi(Par.substr(2u));
+		else if (Par == "-v") Verify = true;
+		else if (Par == "all") for (const auto& Def : DistanceTable::GetDefinitions()) Defs.push_back(&Def);
+		else if (const DistanceTableDef* Def = DistanceTable::GetDefinition(Par)) Defs.push_back(Def);
+		else
+		{
+			std::cout << "Unknown table or option: " << Par << std::endl;
+			return 1;
+		}
+	}
+
+	if (Defs.empty()) // List the tables
+	{
+		std::cout << "Distance tables (files in the current directory):" << std::endl;
+		for (const auto& Def : DistanceTable::GetDefinitions()) CheckTable(Def);
+		return 0;
+	}
+
+	uint Errors = 0u;
+	for (const auto* Def : Defs) if (!(Verify ? CheckTable(*Def) : GenerateTable(*Def, Bits, Threads))) Errors++;
+	return Errors == 0u ? 0 : 1;
+}